@@ -0,0 +1,107 @@
+#include <Dps310.h>
+
+// Dps310 Opject
+Dps310 Dps310PressureSensor = Dps310();
+
+//set by the interrupt handler when a measurement has finished
+volatile bool measurementReady = false;
+
+//longest conversion time (about 207 ms at oversampling rate 128) with some margin, in ms
+const unsigned long measurementTimeout = 250;
+
+void onMeasurementReady();
+
+
+
+void setup()
+{
+  Serial.begin(9600);
+  while (!Serial);
+
+  //Call begin to initialize Dps310PressureSensor
+  //The parameter 0x76 is the bus address. The default address is 0x77 and does not need to be given.
+  //Dps310PressureSensor.begin(Wire, 0x76);
+  Dps310PressureSensor.begin(Wire);
+
+  //the sensor signals every finished temperature and pressure measurement on its SDO pin
+  int16_t ret = Dps310PressureSensor.enableReadyInterrupts();
+  //clear interrupt flags by reading
+  Dps310PressureSensor.getIntStatusPrsReady();
+
+  //initialization of Interrupt for Controller unit
+  //SDO pin of Dps310 has to be connected with interrupt pin
+  int16_t interruptPin = 3;
+  pinMode(interruptPin, INPUT);
+  attachInterrupt(digitalPinToInterrupt(interruptPin), onMeasurementReady, RISING);
+
+  if (ret != 0)
+  {
+    Serial.print("Init FAILED! ret = ");
+    Serial.println(ret);
+  }
+  else
+  {
+    Serial.println("Init complete!");
+  }
+}
+
+
+
+void loop()
+{
+  float pressure;
+  uint8_t oversampling = 7;
+
+  //start a single pressure measurement, the loop is free until it has finished
+  measurementReady = false;
+  int16_t ret = Dps310PressureSensor.startMeasurePressureOnce(oversampling);
+  if (ret != 0)
+  {
+    Serial.print("FAIL! ret = ");
+    Serial.println(ret);
+    delay(500);
+    return;
+  }
+
+  //do other stuff
+  //the wait is limited, the edge is missed if the interrupt line is still high from an earlier result
+  unsigned long startTime = millis();
+  while (!measurementReady && millis() - startTime < measurementTimeout);
+
+  if (measurementReady)
+  {
+    //one bus transfer reads the result and clears the interrupt
+    //This could not be done in the interrupt handler, it would take too much time for a proper ISR
+    ret = Dps310PressureSensor.getReadyResult(pressure);
+  }
+  else
+  {
+    //no interrupt: read the result without it and clear the interrupt flags, so that the next edge comes
+    ret = Dps310PressureSensor.getSingleResult(pressure);
+    Dps310PressureSensor.getIntStatusPrsReady();
+  }
+  if (ret != 0)
+  {
+    //Something went wrong.
+    //Look at the library code for more information about return codes
+    Serial.print("FAIL! ret = ");
+    Serial.println(ret);
+  }
+  else
+  {
+    Serial.print("Pressure: ");
+    Serial.print(pressure);
+    Serial.println(" Pascal");
+  }
+
+  //Wait some time
+  delay(500);
+}
+
+
+//interrupt handler
+void onMeasurementReady()
+{
+  //the bus is only accessed in loop()
+  measurementReady = true;
+}
@@ -1,17 +1,14 @@
 #include <Dps310.h>
+#include <DpsAcquisition.h>
 
 // Dps310 Opject
 Dps310 Dps310PressureSensor = Dps310();
 
-void onFifoFull();
-
-const unsigned char pressureLength = 50;
-unsigned char pressureCount = 0;
-float pressure[pressureLength];
-unsigned char temperatureCount = 0;
-const unsigned char temperatureLength = 50;
-float temperature[temperatureLength];
+//Acquisition object: drains the FIFO into its own buffer and hands over compensated blocks
+//so the interrupt handler never writes into arrays the loop is reading
+DpsAcquisition<Dps310> acquisition(Dps310PressureSensor);
 
+void onFifoFull();
 
 
 
@@ -69,62 +66,44 @@ void setup()
 
 void loop()
 {
-
   //do other stuff
   Serial.println("loop running");
   delay(500);
 
+  //drains the FIFO after an interrupt and compensates the samples as one block
+  //This could not be done in the interrupt handler, it would take too much time for a proper ISR
+  int16_t ret = acquisition.update();
+  if (ret != 0)
+  {
+    Serial.print("FAIL! ret = ");
+    Serial.println(ret);
+  }
 
-  //if result arrays are full
-  //This could also be in the interrupt handler, but it would take too much time for an interrupt
-  if (pressureCount == pressureLength && temperatureCount == temperatureLength)
+  //if a block of results is ready
+  const DpsAcquisition<Dps310>::Block *block = acquisition.getBlock();
+  if (block != NULL)
   {
-    //print results
+    //print results in the order they were measured
     Serial.println();
     Serial.println();
-    Serial.print(temperatureCount);
-    Serial.println(" temperature values found: ");
-    for (int16_t i = 0; i < temperatureCount; i++)
-    {
-      Serial.print(temperature[i]);
-      Serial.println(" degrees of Celsius");
-    }
-
-    Serial.println();
-    Serial.print(pressureCount);
-    Serial.println(" pressure values found: ");
-    for (int16_t i = 0; i < pressureCount; i++)
+    Serial.print(block->getCount());
+    Serial.println(" values found: ");
+    for (uint8_t i = 0; i < block->getCount(); i++)
     {
-      Serial.print(pressure[i]);
-      Serial.println(" Pascal");
+      Serial.print(block->getValue(i));
+      Serial.println(block->isPressure(i) ? " Pascal" : " degrees of Celsius");
     }
     Serial.println();
     Serial.println();
-
-    //reset result counters
-    pressureCount = 0;
-    temperatureCount = 0;
+    //hand the block back, the next one is filled meanwhile
+    acquisition.release();
   }
-
 }
 
 
+//interrupt handler
 void onFifoFull()
 {
-  //message for debugging
-  Serial.println("Interrupt handler called");
-
-  //clear interrupt flag by reading
-  Dps310PressureSensor.getIntStatusFifoFull();
-
-  //calculate the number of free indexes in the result arrays
-  uint8_t prs_freespace = pressureLength - pressureCount;
-  uint8_t temp_freespace = temperatureLength - temperatureCount;
-  //read the results from Dps310, new results will be added at the end of the arrays
-  Dps310PressureSensor.getContResults(&temperature[temperatureCount], temp_freespace, &pressure[pressureCount], prs_freespace);
-  //after reading the result counters are increased by the amount of new results
-  pressureCount += prs_freespace;
-  temperatureCount += temp_freespace;
-
-
+  //the bus is only accessed in loop()
+  acquisition.onInterrupt();
 }
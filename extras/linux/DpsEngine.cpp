@@ -0,0 +1,398 @@
+#include "DpsEngine.h"
+
+#include <algorithm>
+#include <time.h>
+
+//pool and index of the pool thread that runs the current task, so that it posts to its own queue
+static thread_local DpsWorkPool *s_pool = NULL;
+static thread_local unsigned s_poolIndex = 0U;
+
+//////// 		DpsWorkPool			////////
+
+DpsWorkPool::DpsWorkPool(void)
+	: m_pending(0U), m_steals(0U), m_next(0U), m_stop(false)
+{
+}
+
+DpsWorkPool::~DpsWorkPool(void)
+{
+	stop();
+}
+
+void DpsWorkPool::start(unsigned threads)
+{
+	stop();
+	if (threads == 0U)
+	{
+		threads = std::thread::hardware_concurrency();
+	}
+	if (threads == 0U)
+	{
+		threads = 1U;
+	}
+	m_stop = false;
+	m_queues.clear();
+	for (unsigned i = 0; i < threads; i++)
+	{
+		m_queues.push_back(std::unique_ptr<Queue>(new Queue()));
+	}
+	for (unsigned i = 0; i < threads; i++)
+	{
+		m_threads.push_back(std::thread(&DpsWorkPool::run, this, i));
+	}
+}
+
+void DpsWorkPool::stop(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+}
+
+void DpsWorkPool::post(Task task)
+{
+	unsigned index = s_pool == this ? s_poolIndex : m_next++ % m_queues.size();
+	//counted before the task is queued, so that a take() of it never finds the counter at 0;
+	//under the mutex of the wait, so that no thread misses the wake up
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pending++;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+		m_queues[index]->tasks.push_back(std::move(task));
+	}
+	m_wake.notify_one();
+}
+
+uint64_t DpsWorkPool::getSteals(void) const
+{
+	return m_steals;
+}
+
+bool DpsWorkPool::take(unsigned index, Task &task)
+{
+	//own queue first, newest task, its data is most likely still in the cache
+	{
+		Queue &own = *m_queues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty())
+		{
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			m_pending--;
+			return true;
+		}
+	}
+	//then the oldest task of another thread
+	for (size_t i = 1; i < m_queues.size(); i++)
+	{
+		Queue &other = *m_queues[(index + i) % m_queues.size()];
+		std::lock_guard<std::mutex> lock(other.mutex);
+		if (!other.tasks.empty())
+		{
+			task = std::move(other.tasks.front());
+			other.tasks.pop_front();
+			m_pending--;
+			m_steals++;
+			return true;
+		}
+	}
+	return false;
+}
+
+void DpsWorkPool::run(unsigned index)
+{
+	s_pool = this;
+	s_poolIndex = index;
+	while (true)
+	{
+		Task task;
+		if (take(index, task))
+		{
+			task();
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wake.wait(lock, [this] { return m_stop || m_pending > 0U; });
+		//posted tasks are run before stopping
+		if (m_stop && m_pending == 0U)
+		{
+			break;
+		}
+	}
+	s_pool = NULL;
+}
+
+//////// 		DpsStrand			////////
+
+DpsStrand::DpsStrand(DpsWorkPool &pool)
+	: m_pool(pool), m_running(false)
+{
+}
+
+void DpsStrand::post(DpsWorkPool::Task task)
+{
+	bool schedule;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+		schedule = !m_running;
+		m_running = true;
+	}
+	if (schedule)
+	{
+		m_pool.post([this] { run(); });
+	}
+}
+
+void DpsStrand::run(void)
+{
+	for (unsigned i = 0; i < DPS_ENGINE_STRAND_BURST; i++)
+	{
+		DpsWorkPool::Task task;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_tasks.empty())
+			{
+				m_running = false;
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+	//still running: the rest is queued again, so that other strands get their turn
+	m_pool.post([this] { run(); });
+}
+
+//////// 		DpsEngine			////////
+
+DpsEngine::DpsEngine(void)
+	: m_stop(false), m_running(false)
+{
+}
+
+DpsEngine::~DpsEngine(void)
+{
+	stop();
+}
+
+uint8_t DpsEngine::addBus(void)
+{
+	m_buses.push_back(std::unique_ptr<Bus>(new Bus()));
+	return m_buses.size() - 1U;
+}
+
+int16_t DpsEngine::addSensor(uint8_t bus, DpsClass &dps, const DpsPlan_t &plan, Drain drain)
+{
+	if (bus >= m_buses.size() || m_running || m_sensors.size() > UINT8_MAX)
+	{
+		return -1;
+	}
+	Sensor *sensor = new Sensor(m_pool);
+	sensor->dps = &dps;
+	sensor->drain = drain;
+	sensor->plan = plan;
+	sensor->index = m_sensors.size();
+	sensor->interval = dps::drainInterval(plan) * 1000000U;
+	m_sensors.push_back(std::unique_ptr<Sensor>(sensor));
+	m_buses[bus]->sensors.push_back(sensor);
+	return sensor->index;
+}
+
+void DpsEngine::start(const Handler &handler, unsigned threads)
+{
+	if (m_running)
+	{
+		return;
+	}
+	m_handler = handler;
+	m_stop = false;
+	m_running = true;
+	m_pool.start(threads);
+	for (size_t i = 0; i < m_buses.size(); i++)
+	{
+		Bus &bus = *m_buses[i];
+		{
+			std::lock_guard<std::mutex> lock(bus.mutex);
+			bus.busyTime = 0U;
+			bus.startTime = dpsSampleTime();
+			bus.stopTime = 0U;
+			bus.drains = 0U;
+			bus.failures = 0U;
+			bus.samples = 0U;
+			bus.latencyCount = 0U;
+			bus.latencyMax = 0U;
+		}
+		bus.thread = std::thread(&DpsEngine::runBus, this, std::ref(bus));
+	}
+}
+
+void DpsEngine::stop(void)
+{
+	if (!m_running)
+	{
+		return;
+	}
+	m_stop = true;
+	for (size_t i = 0; i < m_buses.size(); i++)
+	{
+		Bus &bus = *m_buses[i];
+		bus.thread.join();
+		std::lock_guard<std::mutex> lock(bus.mutex);
+		bus.stopTime = dpsSampleTime();
+	}
+	//all batches are processed before the pool stops
+	m_pool.stop();
+	m_running = false;
+}
+
+void DpsEngine::runBus(Bus &bus)
+{
+	uint64_t start = dpsSampleTime();
+	for (size_t i = 0; i < bus.sensors.size(); i++)
+	{
+		Sensor &sensor = *bus.sensors[i];
+		const DpsPlan_t &plan = sensor.plan;
+		int16_t ret = sensor.dps->startMeasureBothCont(plan.tempMr, plan.tempOsr, plan.prsMr, plan.prsOsr);
+		//a sensor that does not start is not drained
+		sensor.due = ret == DPS__SUCCEEDED ? start + sensor.interval : UINT64_MAX;
+		if (ret != DPS__SUCCEEDED)
+		{
+			std::lock_guard<std::mutex> lock(bus.mutex);
+			bus.failures++;
+		}
+	}
+
+	while (!m_stop)
+	{
+		//the sensor that is due next
+		Sensor *next = NULL;
+		for (size_t i = 0; i < bus.sensors.size(); i++)
+		{
+			if (next == NULL || bus.sensors[i]->due < next->due)
+			{
+				next = bus.sensors[i];
+			}
+		}
+		uint64_t time = dpsSampleTime();
+		if (next == NULL || next->due > time)
+		{
+			//short sleeps, so that stop() does not wait for a long drain interval
+			uint64_t sleep = (uint64_t)DPS__PLAN_MIN_DRAIN_INTERVAL * 1000000U;
+			if (next != NULL && next->due - time < sleep)
+			{
+				sleep = next->due - time;
+			}
+			struct timespec duration = {(time_t)(sleep / 1000000000ULL), (long)(sleep % 1000000000ULL)};
+			nanosleep(&duration, NULL);
+			continue;
+		}
+
+		std::shared_ptr<Batch> batch(new Batch());
+		batch->count = DPS__FIFO_SIZE;
+		int16_t ret = next->drain(batch->raw, batch->count);
+		batch->timestamp = dpsSampleTime();
+		{
+			std::lock_guard<std::mutex> lock(bus.mutex);
+			bus.busyTime += batch->timestamp - time;
+			bus.drains++;
+			bus.failures += ret != DPS__SUCCEEDED;
+			bus.samples += batch->count;
+		}
+		if (batch->count > 0U)
+		{
+			Sensor *sensor = next;
+			next->strand.post([this, &bus, sensor, batch] { process(bus, *sensor, *batch); });
+		}
+		next->due += next->interval;
+		//after a stall, the schedule starts again from now instead of draining in a burst
+		if (next->due < batch->timestamp)
+		{
+			next->due = batch->timestamp + next->interval;
+		}
+	}
+
+	for (size_t i = 0; i < bus.sensors.size(); i++)
+	{
+		bus.sensors[i]->dps->standby();
+	}
+}
+
+void DpsEngine::process(Bus &bus, Sensor &sensor, const Batch &batch)
+{
+	//the FIFO does not store timestamps: the last result of each type is assumed to be
+	//the most recent one, the others are spaced by the measure rate
+	uint8_t remaining[2] = {0U, 0U};
+	for (uint8_t i = 0; i < batch.count; i++)
+	{
+		remaining[batch.raw[i] & 0x01]++;
+	}
+	const uint64_t period[2] = {1000000000ULL >> sensor.plan.tempMr, 1000000000ULL >> sensor.plan.prsMr};
+
+	for (uint8_t i = 0; i < batch.count; i++)
+	{
+		uint8_t type = batch.raw[i] & 0x01;
+		DpsSample_t sample;
+		sample.value = sensor.dps->compensate(batch.raw[i]);
+		sample.timestamp = batch.timestamp - (uint64_t)(--remaining[type]) * period[type];
+		sample.type = type;
+		sample.sensor = sensor.index;
+		sample.reserved = 0U;
+		m_handler(sample);
+	}
+
+	uint64_t latency = dpsSampleTime() - batch.timestamp;
+	std::lock_guard<std::mutex> lock(bus.mutex);
+	bus.latencies[bus.latencyCount++ % DPS_ENGINE_LATENCY_WINDOW] = latency;
+	bus.latencyMax = std::max(bus.latencyMax, latency);
+}
+
+int16_t DpsEngine::getBusStats(uint8_t index, DpsEngineStats_t &stats)
+{
+	if (index >= m_buses.size())
+	{
+		return -1;
+	}
+	Bus &bus = *m_buses[index];
+	uint64_t latencies[DPS_ENGINE_LATENCY_WINDOW];
+	uint32_t count;
+	{
+		std::lock_guard<std::mutex> lock(bus.mutex);
+		uint64_t end = bus.stopTime != 0U ? bus.stopTime : dpsSampleTime();
+		stats.utilization = end > bus.startTime ? (double)bus.busyTime / (end - bus.startTime) : 0.0;
+		stats.drains = bus.drains;
+		stats.failures = bus.failures;
+		stats.samples = bus.samples;
+		stats.latencyMax = bus.latencyMax;
+		count = std::min(bus.latencyCount, (uint32_t)DPS_ENGINE_LATENCY_WINDOW);
+		std::copy(bus.latencies, bus.latencies + count, latencies);
+	}
+	stats.latencyMedian = 0U;
+	stats.latencyP99 = 0U;
+	if (count > 0U)
+	{
+		//percentiles of the last DPS_ENGINE_LATENCY_WINDOW batches
+		uint64_t *median = latencies + count / 2U;
+		std::nth_element(latencies, median, latencies + count);
+		stats.latencyMedian = *median;
+		uint64_t *p99 = latencies + (count * 99U) / 100U;
+		std::nth_element(latencies, p99, latencies + count);
+		stats.latencyP99 = *p99;
+	}
+	return 0;
+}
+
+uint64_t DpsEngine::getSteals(void) const
+{
+	return m_pool.getSteals();
+}
@@ -0,0 +1,242 @@
+/**
+ * @brief Multi-threaded acquisition for many sensors on many buses
+ *
+ * DpsEngine runs one thread per bus, which owns all bus accesses of the sensors on it:
+ * it starts their continuous measurements, drains each FIFO when it is about half full
+ * and does nothing else. Compensation and the handler of the application run in a
+ * work-stealing pool (DpsWorkPool), so the CPU work of a busy bus is spread over all cores.
+ *
+ * The results of one sensor are processed in FIFO order, one batch after the other
+ * (DpsStrand): the compensation of a pressure uses the temperature compensated last.
+ * Batches of different sensors run in parallel, also when the sensors share a bus.
+ *
+ * For each bus, the engine measures the utilization (share of the time the bus thread
+ * spends in drains) and the latency from a drain to the end of the processing of its batch.
+ *
+ * @file DpsEngine.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSENGINE_H_INCLUDED
+#define DPSENGINE_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DpsClass.h"
+#include "DpsPlanner.h"
+#include "DpsShmRing.h"
+
+//latencies kept per bus for the percentiles
+#define DPS_ENGINE_LATENCY_WINDOW 1024U
+//batches a strand processes before it lets other work run
+#define DPS_ENGINE_STRAND_BURST 8U
+
+/**
+ * @brief thread pool where each thread has its own queue and idle threads steal from the others
+ *
+ * Tasks posted by a pool thread go to its own queue and are taken from the back (most recent first),
+ * tasks posted from outside are spread round robin. An idle thread steals from the front of the
+ * other queues, so the oldest work moves to free cores.
+ */
+class DpsWorkPool
+{
+  public:
+	typedef std::function<void(void)> Task;
+
+	DpsWorkPool(void);
+	~DpsWorkPool(void);
+
+	/**
+	 * @param threads: 	number of threads, 0 for one per core
+	 */
+	void start(unsigned threads);
+
+	/**
+	 * runs all posted tasks and stops the threads
+	 */
+	void stop(void);
+
+	void post(Task task);
+
+	/**
+	 * @return 	number of tasks that were stolen from the queue of another thread
+	 */
+	uint64_t getSteals(void) const;
+
+  private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void run(unsigned index);
+	bool take(unsigned index, Task &task);
+
+	std::vector<std::unique_ptr<Queue>> m_queues;
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::atomic<uint64_t> m_pending;
+	std::atomic<uint64_t> m_steals;
+	std::atomic<unsigned> m_next;
+	bool m_stop;
+};
+
+/**
+ * @brief runs the tasks posted to it one after the other, in the order they were posted, on a DpsWorkPool
+ */
+class DpsStrand
+{
+  public:
+	explicit DpsStrand(DpsWorkPool &pool);
+
+	void post(DpsWorkPool::Task task);
+
+  private:
+	void run(void);
+
+	DpsWorkPool &m_pool;
+	std::mutex m_mutex;
+	std::deque<DpsWorkPool::Task> m_tasks;
+	bool m_running;
+};
+
+/**
+ * @brief statistics of one bus, see DpsEngine::getBusStats
+ */
+typedef struct
+{
+	double utilization;		 //share of the time the bus thread spent in drains since start()
+	uint64_t drains;		 //drains of all sensors on the bus
+	uint64_t failures;		 //drains that failed
+	uint64_t samples;		 //results read from the FIFOs
+	uint64_t latencyMedian;	 //ns from the end of a drain to the end of the processing of its batch
+	uint64_t latencyP99;	 //99th percentile of the latency in ns
+	uint64_t latencyMax;	 //maximum latency in ns
+} DpsEngineStats_t;
+
+class DpsEngine
+{
+  public:
+	/**
+	 * called for each result in the pool, in FIFO order for each sensor;
+	 * handlers of different sensors may run at the same time
+	 */
+	typedef std::function<void(const DpsSample_t &)> Handler;
+
+	DpsEngine(void);
+	~DpsEngine(void);
+
+	/**
+	 * adds a bus, which gets its own thread
+	 *
+	 * @return 	index of the bus
+	 */
+	uint8_t addBus(void);
+
+	/**
+	 * adds an initialized sensor (begin() done) to a bus. While the engine runs, the sensor must not be used
+	 * otherwise: the thread of the bus does all bus accesses, the pool calls compensate().
+	 * Its index is passed to the handler in DpsSample_t::sensor.
+	 *
+	 * @param bus: 		index returned by addBus
+	 * @param &sensor: 	Dps310, Dps422 or one of the DpsSensor types
+	 * @param &plan: 		measure rates and oversampling rates, e.g. from dps::planMeasurement()
+	 * @return 	index of the sensor, -1 if the bus does not exist or the engine is running
+	 */
+	template <class Chip>
+	int16_t addSensor(uint8_t bus, Chip &sensor, const DpsPlan_t &plan)
+	{
+		//getContRawResults is not virtual, it is bound here
+		return addSensor(bus, sensor, plan, [&sensor](int32_t *raw, uint8_t &count) {
+			return sensor.getContRawResults(raw, count);
+		});
+	}
+
+	/**
+	 * starts the measurements, the bus threads and the pool
+	 *
+	 * @param &handler: 	gets every result
+	 * @param threads: 	threads of the pool, 0 for one per core
+	 */
+	void start(const Handler &handler, unsigned threads = 0U);
+
+	/**
+	 * stops the bus threads and puts the sensors to standby, then waits until all results have been processed
+	 */
+	void stop(void);
+
+	/**
+	 * @return 	0 on success, -1 if the bus does not exist
+	 */
+	int16_t getBusStats(uint8_t bus, DpsEngineStats_t &stats);
+
+	/**
+	 * @return 	number of tasks the pool moved from a busy thread to an idle one
+	 */
+	uint64_t getSteals(void) const;
+
+  private:
+	typedef std::function<int16_t(int32_t *, uint8_t &)> Drain;
+
+	struct Sensor
+	{
+		explicit Sensor(DpsWorkPool &pool) : strand(pool) {}
+
+		DpsClass *dps;
+		Drain drain;
+		DpsPlan_t plan;
+		uint8_t index;
+		uint32_t interval; //ns between drains
+		uint64_t due;
+		DpsStrand strand;
+	};
+
+	struct Bus
+	{
+		std::vector<Sensor *> sensors;
+		std::thread thread;
+
+		std::mutex mutex; //for all statistics below
+		uint64_t busyTime;
+		uint64_t startTime;
+		uint64_t stopTime;
+		uint64_t drains;
+		uint64_t failures;
+		uint64_t samples;
+		uint64_t latencies[DPS_ENGINE_LATENCY_WINDOW];
+		uint32_t latencyCount;
+		uint64_t latencyMax;
+	};
+
+	/**
+	 * @brief raw values of one drain
+	 */
+	struct Batch
+	{
+		int32_t raw[DPS__FIFO_SIZE];
+		uint8_t count;
+		uint64_t timestamp;
+	};
+
+	int16_t addSensor(uint8_t bus, DpsClass &dps, const DpsPlan_t &plan, Drain drain);
+	void runBus(Bus &bus);
+	void process(Bus &bus, Sensor &sensor, const Batch &batch);
+
+	DpsWorkPool m_pool;
+	std::vector<std::unique_ptr<Bus>> m_buses;
+	std::vector<std::unique_ptr<Sensor>> m_sensors;
+	Handler m_handler;
+	std::atomic<bool> m_stop;
+	bool m_running;
+};
+
+#endif //DPSENGINE_H_INCLUDED
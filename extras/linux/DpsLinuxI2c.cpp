@@ -0,0 +1,196 @@
+#include "DpsLinuxI2c.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// register pairs (address write + data read) per I2C_RDWR transfer
+#define DPS_I2C_MAX_BLOCKS_PER_TRANSFER (I2C_RDWR_IOCTL_MAX_MSGS / 2)
+
+//////// 		DpsI2cDev			////////
+
+DpsI2cDev::DpsI2cDev(void) : m_fd(-1)
+{
+}
+
+DpsI2cDev::~DpsI2cDev(void)
+{
+	close();
+}
+
+int DpsI2cDev::open(int busNumber)
+{
+	char path[32];
+	snprintf(path, sizeof(path), "/dev/i2c-%d", busNumber);
+	return open(path);
+}
+
+int DpsI2cDev::open(const char *path)
+{
+	close();
+	m_fd = ::open(path, O_RDWR | O_CLOEXEC);
+	if (m_fd < 0)
+	{
+		return -errno;
+	}
+	return 0;
+}
+
+void DpsI2cDev::close(void)
+{
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+}
+
+int DpsI2cDev::transfer(struct i2c_msg *msgs, uint32_t count)
+{
+	if (m_fd < 0)
+	{
+		return -EBADF;
+	}
+	struct i2c_rdwr_ioctl_data data;
+	data.msgs = msgs;
+	data.nmsgs = count;
+	if (ioctl(m_fd, I2C_RDWR, &data) < 0)
+	{
+		return -errno;
+	}
+	return 0;
+}
+
+//////// 		DpsI2cSim			////////
+
+DpsI2cSim::DpsI2cSim(uint8_t chip, uint8_t slaveAddress)
+	: DpsSimChip(chip), m_slaveAddress(slaveAddress), m_pointer(0U)
+{
+}
+
+int DpsI2cSim::transfer(struct i2c_msg *msgs, uint32_t count)
+{
+	if (count == 0U || count > I2C_RDWR_IOCTL_MAX_MSGS)
+	{
+		return -EINVAL;
+	}
+	if (startTransfer() != DPS__SUCCEEDED)
+	{
+		return -EIO;
+	}
+	for (uint32_t i = 0; i < count; i++)
+	{
+		struct i2c_msg &msg = msgs[i];
+		//no device with this address: address is not acknowledged
+		if (msg.addr != m_slaveAddress)
+		{
+			return -ENXIO;
+		}
+		if (msg.flags & I2C_M_RD)
+		{
+			for (uint16_t j = 0; j < msg.len; j++)
+			{
+				msg.buf[j] = readRegister(m_pointer++);
+			}
+		}
+		else if (msg.len > 0U)
+		{
+			//first byte sets the register pointer, the following ones are written
+			m_pointer = msg.buf[0];
+			for (uint16_t j = 1; j < msg.len; j++)
+			{
+				writeRegister(m_pointer++, msg.buf[j]);
+			}
+		}
+	}
+	return 0;
+}
+
+//////// 		DpsLinuxI2c			////////
+
+DpsLinuxI2c::DpsLinuxI2c(DpsI2cAdapter &adapter, uint8_t slaveAddress)
+	: m_adapter(adapter), m_slaveAddress(slaveAddress)
+{
+}
+
+int16_t DpsLinuxI2c::readBlock(uint8_t regAddress, uint8_t length, uint8_t *buffer)
+{
+	//register address write and data read with repeated start in one transfer
+	struct i2c_msg msgs[2];
+	msgs[0].addr = m_slaveAddress;
+	msgs[0].flags = 0U;
+	msgs[0].len = 1U;
+	msgs[0].buf = &regAddress;
+	msgs[1].addr = m_slaveAddress;
+	msgs[1].flags = I2C_M_RD;
+	msgs[1].len = length;
+	msgs[1].buf = buffer;
+	if (m_adapter.transfer(msgs, 2U) < 0)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	return length;
+}
+
+int16_t DpsLinuxI2c::writeByte(uint8_t regAddress, uint8_t data)
+{
+	uint8_t buffer[2] = {regAddress, data};
+	struct i2c_msg msg;
+	msg.addr = m_slaveAddress;
+	msg.flags = 0U;
+	msg.len = 2U;
+	msg.buf = buffer;
+	if (m_adapter.transfer(&msg, 1U) < 0)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	return DPS__SUCCEEDED;
+}
+
+int16_t DpsLinuxI2c::readBlocks(uint8_t regAddress, uint8_t length, uint8_t count, uint8_t *buffer)
+{
+	struct i2c_msg msgs[DPS_I2C_MAX_BLOCKS_PER_TRANSFER * 2];
+	uint8_t done = 0U;
+	while (done < count)
+	{
+		uint8_t blocks = count - done;
+		if (blocks > DPS_I2C_MAX_BLOCKS_PER_TRANSFER)
+		{
+			blocks = DPS_I2C_MAX_BLOCKS_PER_TRANSFER;
+		}
+		//one address write and one read per block, all with repeated start
+		for (uint8_t i = 0; i < blocks; i++)
+		{
+			msgs[2 * i].addr = m_slaveAddress;
+			msgs[2 * i].flags = 0U;
+			msgs[2 * i].len = 1U;
+			msgs[2 * i].buf = &regAddress;
+			msgs[2 * i + 1].addr = m_slaveAddress;
+			msgs[2 * i + 1].flags = I2C_M_RD;
+			msgs[2 * i + 1].len = length;
+			msgs[2 * i + 1].buf = buffer + (uint16_t)(done + i) * length;
+		}
+		if (m_adapter.transfer(msgs, 2U * blocks) < 0)
+		{
+			return done == 0U ? DPS__FAIL_UNKNOWN : done;
+		}
+		done += blocks;
+	}
+	return done;
+}
+
+int16_t DpsLinuxI2c::recover(void)
+{
+	//start, address and stop only: ends a transfer the sensor might still be in.
+	//A sensor holding SDA low is clocked free by the kernel, if the adapter driver supports bus recovery.
+	struct i2c_msg msg;
+	msg.addr = m_slaveAddress;
+	msg.flags = 0U;
+	msg.len = 0U;
+	msg.buf = NULL;
+	m_adapter.transfer(&msg, 1U);
+	//the sensor does not acknowledge during its reset, so the result does not matter
+	return DPS__SUCCEEDED;
+}
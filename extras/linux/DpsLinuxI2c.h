@@ -0,0 +1,114 @@
+/**
+ * @brief Linux userspace I2C backend (/dev/i2c-N)
+ *
+ * DpsLinuxI2c connects a DpsClass sensor to a Linux I2C adapter.
+ * Every register or block read is a single I2C_RDWR transfer with a repeated start
+ * (register address write, then read), instead of separate write and read transfers.
+ * FIFO drains (DpsTransport::readBlocks) are packed into as few I2C_RDWR transfers as
+ * the kernel allows (I2C_RDWR_IOCTL_MAX_MSGS messages each).
+ *
+ * The adapter is exchangeable: DpsI2cDev talks to /dev/i2c-N, DpsI2cSim emulates a sensor
+ * in software (DpsSimChip), so the driver can be exercised without hardware.
+ *
+ * @file DpsLinuxI2c.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSLINUXI2C_H_INCLUDED
+#define DPSLINUXI2C_H_INCLUDED
+
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "DpsTransport.h"
+#include "DpsSimChip.h"
+
+/**
+ * @brief an I2C adapter that executes combined transfers with I2C_RDWR semantics
+ */
+class DpsI2cAdapter
+{
+  public:
+	virtual ~DpsI2cAdapter(void) {}
+
+	/**
+	 * executes all messages as one combined transfer (repeated start between messages)
+	 *
+	 * @param msgs: 	messages as for the I2C_RDWR ioctl
+	 * @param count: 	number of messages, at most I2C_RDWR_IOCTL_MAX_MSGS
+	 * @return 	0 on success, negative errno on fail
+	 */
+	virtual int transfer(struct i2c_msg *msgs, uint32_t count) = 0;
+};
+
+/**
+ * @brief adapter for the Linux i2c-dev interface
+ */
+class DpsI2cDev : public DpsI2cAdapter
+{
+  public:
+	DpsI2cDev(void);
+	~DpsI2cDev(void);
+
+	/**
+	 * opens /dev/i2c-<busNumber>
+	 *
+	 * @return 	0 on success, negative errno on fail
+	 */
+	int open(int busNumber);
+
+	/**
+	 * opens an i2c-dev device node
+	 *
+	 * @return 	0 on success, negative errno on fail
+	 */
+	int open(const char *path);
+
+	void close(void);
+
+	int transfer(struct i2c_msg *msgs, uint32_t count);
+
+  private:
+	int m_fd;
+};
+
+/**
+ * @brief software stand-in for an adapter with one DPS310 or DPS422 attached
+ *
+ * The sensor is modelled by DpsSimChip; register pointer and auto increment
+ * follow the I2C protocol of the sensor.
+ */
+class DpsI2cSim : public DpsI2cAdapter, public DpsSimChip
+{
+  public:
+	DpsI2cSim(uint8_t chip = SIM_DPS310, uint8_t slaveAddress = DPS__STD_SLAVE_ADDRESS);
+
+	int transfer(struct i2c_msg *msgs, uint32_t count);
+
+  private:
+	uint8_t m_slaveAddress;
+	uint8_t m_pointer;
+};
+
+/**
+ * @brief DpsTransport on a Linux I2C adapter
+ */
+class DpsLinuxI2c : public DpsTransport
+{
+  public:
+	/**
+	 * @param &adapter: 		adapter the sensor is connected to
+	 * @param slaveAddress: 	I2C address of the sensor (0x77 or 0x76)
+	 */
+	DpsLinuxI2c(DpsI2cAdapter &adapter, uint8_t slaveAddress = DPS__STD_SLAVE_ADDRESS);
+
+	int16_t readBlock(uint8_t regAddress, uint8_t length, uint8_t *buffer);
+	int16_t writeByte(uint8_t regAddress, uint8_t data);
+	int16_t readBlocks(uint8_t regAddress, uint8_t length, uint8_t count, uint8_t *buffer);
+	int16_t recover(void);
+
+  private:
+	DpsI2cAdapter &m_adapter;
+	uint8_t m_slaveAddress;
+};
+
+#endif //DPSLINUXI2C_H_INCLUDED
@@ -0,0 +1,278 @@
+#include "DpsLinuxSpi.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+//////// 		DpsSpiDev			////////
+
+DpsSpiDev::DpsSpiDev(void) : m_fd(-1)
+{
+}
+
+DpsSpiDev::~DpsSpiDev(void)
+{
+	close();
+}
+
+int DpsSpiDev::open(int bus, int chipSelect, uint32_t speedHz)
+{
+	char path[32];
+	snprintf(path, sizeof(path), "/dev/spidev%d.%d", bus, chipSelect);
+	return open(path, speedHz);
+}
+
+int DpsSpiDev::open(const char *path, uint32_t speedHz)
+{
+	close();
+	m_fd = ::open(path, O_RDWR | O_CLOEXEC);
+	if (m_fd < 0)
+	{
+		return -errno;
+	}
+	//same settings as DpsClass uses with SPIClass
+	uint8_t mode = SPI_MODE_3;
+	uint8_t bits = 8U;
+	if (ioctl(m_fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+		ioctl(m_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+		ioctl(m_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speedHz) < 0)
+	{
+		int ret = -errno;
+		close();
+		return ret;
+	}
+	return 0;
+}
+
+void DpsSpiDev::close(void)
+{
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+}
+
+int DpsSpiDev::transfer(struct spi_ioc_transfer *xfers, uint32_t count)
+{
+	if (m_fd < 0)
+	{
+		return -EBADF;
+	}
+	if (ioctl(m_fd, SPI_IOC_MESSAGE(count), xfers) < 0)
+	{
+		return -errno;
+	}
+	return 0;
+}
+
+//////// 		DpsSpiSim			////////
+
+DpsSpiSim::DpsSpiSim(uint8_t chip)
+	: DpsSimChip(chip), m_frameStarted(0U), m_read(0U), m_pointer(0U)
+{
+}
+
+int DpsSpiSim::transfer(struct spi_ioc_transfer *xfers, uint32_t count)
+{
+	if (count == 0U)
+	{
+		return -EINVAL;
+	}
+	if (startTransfer() != DPS__SUCCEEDED)
+	{
+		return -EIO;
+	}
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const uint8_t *tx = (const uint8_t *)(uintptr_t)xfers[i].tx_buf;
+		uint8_t *rx = (uint8_t *)(uintptr_t)xfers[i].rx_buf;
+		for (uint32_t j = 0; j < xfers[i].len; j++)
+		{
+			uint8_t in = tx != NULL ? tx[j] : 0U;
+			uint8_t out = 0xFFU;
+			if (!m_frameStarted)
+			{
+				//first byte of a frame: read flag and register address
+				m_frameStarted = 1U;
+				m_read = in & DPS310__SPI_RW_MASK;
+				m_pointer = in & ~DPS310__SPI_RW_MASK;
+			}
+			else if (m_read)
+			{
+				out = readRegister(m_pointer++);
+			}
+			else
+			{
+				writeRegister(m_pointer++, in);
+			}
+			if (rx != NULL)
+			{
+				rx[j] = out;
+			}
+		}
+		//chip select is released after the last transfer unless cs_change is set, and
+		//after the other transfers only if cs_change is set
+		if ((i == count - 1U) != (xfers[i].cs_change != 0U))
+		{
+			m_frameStarted = 0U;
+		}
+	}
+	return 0;
+}
+
+//////// 		DpsLinuxSpi			////////
+
+DpsLinuxSpi::DpsLinuxSpi(DpsSpiAdapter &adapter)
+	: m_adapter(adapter), m_xferCount(0U), m_byteCount(0U), m_batchDepth(0U)
+{
+}
+
+int16_t DpsLinuxSpi::readBlock(uint8_t regAddress, uint8_t length, uint8_t *buffer)
+{
+	int16_t offset = queueRead(regAddress, length);
+	if (offset < 0 || flush() != DPS__SUCCEEDED)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	//the first byte was received while sending the command
+	memcpy(buffer, &m_rxBuffer[offset + 1], length);
+	return length;
+}
+
+int16_t DpsLinuxSpi::writeByte(uint8_t regAddress, uint8_t data)
+{
+	int16_t offset = queue((regAddress & ~DPS310__SPI_RW_MASK) | DPS310__SPI_WRITE_CMD, 2U);
+	if (offset < 0)
+	{
+		//message is full, send it and start a new one
+		if (flush() != DPS__SUCCEEDED)
+		{
+			return DPS__FAIL_UNKNOWN;
+		}
+		offset = queue((regAddress & ~DPS310__SPI_RW_MASK) | DPS310__SPI_WRITE_CMD, 2U);
+	}
+	m_txBuffer[offset + 1] = data;
+	//outside of a batch the write is sent immediately
+	if (m_batchDepth == 0U)
+	{
+		return flush();
+	}
+	return DPS__SUCCEEDED;
+}
+
+int16_t DpsLinuxSpi::readBlocks(uint8_t regAddress, uint8_t length, uint8_t count, uint8_t *buffer)
+{
+	int16_t offsets[DPS_SPI_MAX_TRANSFERS];
+	uint8_t done = 0U;
+	while (done < count)
+	{
+		//as many reads as fit into the message, each one in its own chip select frame
+		uint8_t blocks = 0U;
+		while (done + blocks < count)
+		{
+			int16_t offset = queue((regAddress & ~DPS310__SPI_RW_MASK) | DPS310__SPI_READ_CMD, length + 1U);
+			if (offset < 0)
+			{
+				break;
+			}
+			offsets[blocks++] = offset;
+		}
+		if (flush() != DPS__SUCCEEDED)
+		{
+			return done == 0U ? DPS__FAIL_UNKNOWN : done;
+		}
+		for (uint8_t i = 0; i < blocks; i++)
+		{
+			memcpy(buffer + (uint16_t)(done + i) * length, &m_rxBuffer[offsets[i] + 1], length);
+		}
+		done += blocks;
+	}
+	return done;
+}
+
+void DpsLinuxSpi::beginBatch(void)
+{
+	m_batchDepth++;
+}
+
+int16_t DpsLinuxSpi::endBatch(void)
+{
+	if (m_batchDepth > 0U)
+	{
+		m_batchDepth--;
+	}
+	if (m_batchDepth > 0U)
+	{
+		return DPS__SUCCEEDED;
+	}
+	return flush();
+}
+
+int16_t DpsLinuxSpi::flush(void)
+{
+	if (m_xferCount == 0U)
+	{
+		return DPS__SUCCEEDED;
+	}
+	//release chip select at the end of the message
+	m_xfers[m_xferCount - 1U].cs_change = 0U;
+	int ret = m_adapter.transfer(m_xfers, m_xferCount);
+	m_xferCount = 0U;
+	m_byteCount = 0U;
+	return ret < 0 ? DPS__FAIL_UNKNOWN : DPS__SUCCEEDED;
+}
+
+int16_t DpsLinuxSpi::recover(void)
+{
+	//drop deferred writes, they might be what the sensor did not understand
+	m_xferCount = 0U;
+	m_byteCount = 0U;
+	//an empty chip select frame resets the SPI interface of the sensor
+	struct spi_ioc_transfer xfer;
+	memset(&xfer, 0, sizeof(xfer));
+	return m_adapter.transfer(&xfer, 1U) < 0 ? DPS__FAIL_UNKNOWN : DPS__SUCCEEDED;
+}
+
+int16_t DpsLinuxSpi::queue(uint8_t command, uint16_t length)
+{
+	if (m_xferCount >= DPS_SPI_MAX_TRANSFERS || m_byteCount + length > DPS_SPI_MAX_MESSAGE_BYTES)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	uint16_t offset = m_byteCount;
+	m_txBuffer[offset] = command;
+	//dummy bytes while receiving
+	memset(&m_txBuffer[offset + 1], 0xFF, length - 1U);
+
+	struct spi_ioc_transfer &xfer = m_xfers[m_xferCount];
+	memset(&xfer, 0, sizeof(xfer));
+	xfer.tx_buf = (uintptr_t)&m_txBuffer[offset];
+	xfer.rx_buf = (uintptr_t)&m_rxBuffer[offset];
+	xfer.len = length;
+	//chip select is released between transfers, every register access is a frame of its own
+	xfer.cs_change = 1U;
+
+	m_xferCount++;
+	m_byteCount += length;
+	return offset;
+}
+
+int16_t DpsLinuxSpi::queueRead(uint8_t regAddress, uint8_t length)
+{
+	uint8_t command = (regAddress & ~DPS310__SPI_RW_MASK) | DPS310__SPI_READ_CMD;
+	int16_t offset = queue(command, length + 1U);
+	if (offset < 0)
+	{
+		//message is full, send it and start a new one
+		if (flush() != DPS__SUCCEEDED)
+		{
+			return DPS__FAIL_UNKNOWN;
+		}
+		offset = queue(command, length + 1U);
+	}
+	return offset;
+}
@@ -0,0 +1,146 @@
+/**
+ * @brief Linux userspace SPI backend (/dev/spidevB.C)
+ *
+ * DpsLinuxSpi connects a DpsClass sensor to a Linux SPI device.
+ * Every register access is one spi_ioc_transfer with its own chip select frame,
+ * and as many of them as possible are sent with a single SPI_IOC_MESSAGE ioctl:
+ * - a block read is one transfer (command byte and data in one full duplex frame),
+ *   instead of one transfer per byte as a direct port of DpsClass::readBlockSPI would do
+ * - FIFO drains (DpsTransport::readBlocks) put all result reads into one message
+ * - within a batch (DpsTransport::beginBatch), writes are queued and sent in the same
+ *   message as the next read, so whole initialization and configuration sequences
+ *   need one ioctl per read instead of one per register access
+ *
+ * The adapter is exchangeable: DpsSpiDev talks to /dev/spidevB.C, DpsSpiSim emulates a sensor
+ * in software (DpsSimChip).
+ *
+ * @file DpsLinuxSpi.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSLINUXSPI_H_INCLUDED
+#define DPSLINUXSPI_H_INCLUDED
+
+#include <linux/spi/spidev.h>
+#include "DpsTransport.h"
+#include "DpsSimChip.h"
+
+//transfers per SPI_IOC_MESSAGE
+#define DPS_SPI_MAX_TRANSFERS 32U
+//bytes of all transfers of one message, below the default spidev buffer size of 4096
+#define DPS_SPI_MAX_MESSAGE_BYTES 512U
+
+/**
+ * @brief an SPI adapter that executes messages with SPI_IOC_MESSAGE semantics
+ */
+class DpsSpiAdapter
+{
+  public:
+	virtual ~DpsSpiAdapter(void) {}
+
+	/**
+	 * executes all transfers as one message.
+	 * Chip select is deasserted after the last transfer and after every transfer with cs_change set.
+	 *
+	 * @param xfers: 	transfers as for the SPI_IOC_MESSAGE ioctl
+	 * @param count: 	number of transfers
+	 * @return 	0 on success, negative errno on fail
+	 */
+	virtual int transfer(struct spi_ioc_transfer *xfers, uint32_t count) = 0;
+};
+
+/**
+ * @brief adapter for the Linux spidev interface
+ */
+class DpsSpiDev : public DpsSpiAdapter
+{
+  public:
+	DpsSpiDev(void);
+	~DpsSpiDev(void);
+
+	/**
+	 * opens /dev/spidev<bus>.<chipSelect> and sets SPI mode 3, 8 bit words and the clock
+	 *
+	 * @param speedHz: 	clock frequency, at most DPS310__SPI_MAX_FREQ is recommended
+	 * @return 	0 on success, negative errno on fail
+	 */
+	int open(int bus, int chipSelect, uint32_t speedHz = DPS310__SPI_MAX_FREQ);
+
+	/**
+	 * opens a spidev device node, see above
+	 *
+	 * @return 	0 on success, negative errno on fail
+	 */
+	int open(const char *path, uint32_t speedHz = DPS310__SPI_MAX_FREQ);
+
+	void close(void);
+
+	int transfer(struct spi_ioc_transfer *xfers, uint32_t count);
+
+  private:
+	int m_fd;
+};
+
+/**
+ * @brief software stand-in for an SPI device with one DPS310 or DPS422 attached
+ *
+ * The sensor is modelled by DpsSimChip; every chip select frame starts with the
+ * command byte (read flag and register address), followed by auto incremented data.
+ */
+class DpsSpiSim : public DpsSpiAdapter, public DpsSimChip
+{
+  public:
+	explicit DpsSpiSim(uint8_t chip = SIM_DPS310);
+
+	int transfer(struct spi_ioc_transfer *xfers, uint32_t count);
+
+  private:
+	uint8_t m_frameStarted;
+	uint8_t m_read;
+	uint8_t m_pointer;
+};
+
+/**
+ * @brief DpsTransport on a Linux SPI adapter (4-wire)
+ */
+class DpsLinuxSpi : public DpsTransport
+{
+  public:
+	/**
+	 * @param &adapter: 	adapter the sensor is connected to
+	 */
+	explicit DpsLinuxSpi(DpsSpiAdapter &adapter);
+
+	int16_t readBlock(uint8_t regAddress, uint8_t length, uint8_t *buffer);
+	int16_t writeByte(uint8_t regAddress, uint8_t data);
+	int16_t readBlocks(uint8_t regAddress, uint8_t length, uint8_t count, uint8_t *buffer);
+	void beginBatch(void);
+	int16_t endBatch(void);
+	int16_t flush(void);
+	int16_t recover(void);
+
+  private:
+	/**
+	 * appends a transfer of length bytes to the pending message; the first byte is the command
+	 *
+	 * @return 	offset of the transfer in the message buffers or -1 if the message is full
+	 */
+	int16_t queue(uint8_t command, uint16_t length);
+
+	/**
+	 * queues a read transfer, sending the pending message first if it is full
+	 *
+	 * @return 	offset of the transfer in the message buffers or -1 on fail
+	 */
+	int16_t queueRead(uint8_t regAddress, uint8_t length);
+
+	DpsSpiAdapter &m_adapter;
+	struct spi_ioc_transfer m_xfers[DPS_SPI_MAX_TRANSFERS];
+	uint8_t m_txBuffer[DPS_SPI_MAX_MESSAGE_BYTES];
+	uint8_t m_rxBuffer[DPS_SPI_MAX_MESSAGE_BYTES];
+	uint8_t m_xferCount;
+	uint16_t m_byteCount;
+	uint8_t m_batchDepth;
+};
+
+#endif //DPSLINUXSPI_H_INCLUDED
@@ -0,0 +1,254 @@
+#include "DpsShmRing.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+//////// 		DpsShmWriter			////////
+
+DpsShmWriter::DpsShmWriter(void)
+	: m_header(NULL), m_slots(NULL), m_mask(0U), m_size(0U)
+{
+	m_name[0] = '\0';
+}
+
+DpsShmWriter::~DpsShmWriter(void)
+{
+	close();
+}
+
+int DpsShmWriter::create(const char *name, uint32_t capacity)
+{
+	close();
+	//power of 2, so the slot of an index is found with a mask
+	uint32_t slots = 1U;
+	while (slots < capacity)
+	{
+		slots <<= 1;
+	}
+	size_t size = sizeof(DpsShmHeader_t) + (size_t)slots * sizeof(DpsShmSlot_t);
+
+	//a new object, so readers of a previous daemon keep their old mapping and see the writer gone
+	shm_unlink(name);
+	int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0)
+	{
+		return -errno;
+	}
+	if (ftruncate(fd, size) < 0)
+	{
+		int ret = -errno;
+		::close(fd);
+		shm_unlink(name);
+		return ret;
+	}
+	void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (mem == MAP_FAILED)
+	{
+		int ret = -errno;
+		shm_unlink(name);
+		return ret;
+	}
+
+	m_header = new (mem) DpsShmHeader_t;
+	m_slots = (DpsShmSlot_t *)(m_header + 1);
+	for (uint32_t i = 0; i < slots; i++)
+	{
+		new (&m_slots[i]) DpsShmSlot_t;
+		m_slots[i].seq.store(0U, std::memory_order_relaxed);
+	}
+	m_header->slotSize = sizeof(DpsShmSlot_t);
+	m_header->version = DPS_SHM_VERSION;
+	m_header->capacity = slots;
+	m_header->reserved = 0U;
+	m_header->writeIndex.store(0U, std::memory_order_relaxed);
+	m_header->notifyCount.store(0U, std::memory_order_relaxed);
+	m_header->writerPid.store((uint32_t)getpid(), std::memory_order_relaxed);
+	//readers accept the ring once the magic is visible
+	std::atomic_thread_fence(std::memory_order_release);
+	m_header->magic = DPS_SHM_MAGIC;
+
+	m_mask = slots - 1U;
+	m_size = size;
+	snprintf(m_name, sizeof(m_name), "%s", name);
+	return 0;
+}
+
+void DpsShmWriter::close(void)
+{
+	if (m_header == NULL)
+	{
+		return;
+	}
+	m_header->writerPid.store(0U, std::memory_order_release);
+	notify();
+	munmap(m_header, m_size);
+	shm_unlink(m_name);
+	m_header = NULL;
+	m_slots = NULL;
+}
+
+void DpsShmWriter::publish(const DpsSample_t &sample)
+{
+	uint64_t index = m_header->writeIndex.load(std::memory_order_relaxed);
+	DpsShmSlot_t &slot = m_slots[index & m_mask];
+	//odd sequence number: slot is being written
+	slot.seq.store(2U * index + 1U, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.sample = sample;
+	slot.seq.store(2U * (index + 1U), std::memory_order_release);
+	m_header->writeIndex.store(index + 1U, std::memory_order_release);
+}
+
+void DpsShmWriter::notify(void)
+{
+	m_header->notifyCount.fetch_add(1U, std::memory_order_release);
+	syscall(SYS_futex, &m_header->notifyCount, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+//////// 		DpsShmReader			////////
+
+DpsShmReader::DpsShmReader(void)
+	: m_header(NULL), m_slots(NULL), m_mask(0U), m_size(0U), m_readIndex(0U), m_seq(0U), m_lost(0U)
+{
+}
+
+DpsShmReader::~DpsShmReader(void)
+{
+	close();
+}
+
+int DpsShmReader::open(const char *name)
+{
+	close();
+	int fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+	{
+		return -errno;
+	}
+	struct stat info;
+	if (fstat(fd, &info) < 0 || (size_t)info.st_size < sizeof(DpsShmHeader_t))
+	{
+		::close(fd);
+		return -EINVAL;
+	}
+	void *mem = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (mem == MAP_FAILED)
+	{
+		return -errno;
+	}
+	const DpsShmHeader_t *header = (const DpsShmHeader_t *)mem;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (header->magic != DPS_SHM_MAGIC || header->version != DPS_SHM_VERSION ||
+		header->slotSize != sizeof(DpsShmSlot_t) ||
+		(size_t)info.st_size < sizeof(DpsShmHeader_t) + (size_t)header->capacity * sizeof(DpsShmSlot_t))
+	{
+		munmap(mem, info.st_size);
+		return -EPROTO;
+	}
+	m_header = header;
+	m_slots = (const DpsShmSlot_t *)(header + 1);
+	m_mask = header->capacity - 1U;
+	m_size = info.st_size;
+	m_readIndex = header->writeIndex.load(std::memory_order_acquire);
+	m_lost = 0U;
+	return 0;
+}
+
+void DpsShmReader::close(void)
+{
+	if (m_header == NULL)
+	{
+		return;
+	}
+	munmap((void *)m_header, m_size);
+	m_header = NULL;
+	m_slots = NULL;
+}
+
+const DpsSample_t *DpsShmReader::peek(void)
+{
+	uint64_t writeIndex = m_header->writeIndex.load(std::memory_order_acquire);
+	while (m_readIndex < writeIndex)
+	{
+		//samples older than one ring length are overwritten
+		if (writeIndex - m_readIndex > m_mask + 1U)
+		{
+			m_lost += writeIndex - (m_mask + 1U) - m_readIndex;
+			m_readIndex = writeIndex - (m_mask + 1U);
+		}
+		const DpsShmSlot_t &slot = m_slots[m_readIndex & m_mask];
+		m_seq = slot.seq.load(std::memory_order_acquire);
+		if (m_seq == 2U * (m_readIndex + 1U))
+		{
+			return &slot.sample;
+		}
+		//overwritten or being overwritten right now
+		m_lost++;
+		m_readIndex++;
+	}
+	return NULL;
+}
+
+int16_t DpsShmReader::release(void)
+{
+	const DpsShmSlot_t &slot = m_slots[m_readIndex & m_mask];
+	//the sample must be read completely before the sequence number is checked again
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+	m_readIndex++;
+	if (seq != m_seq)
+	{
+		m_lost++;
+		return DPS__FAIL_UNKNOWN;
+	}
+	return DPS__SUCCEEDED;
+}
+
+int16_t DpsShmReader::read(DpsSample_t &sample)
+{
+	const DpsSample_t *next;
+	while ((next = peek()) != NULL)
+	{
+		sample = *next;
+		if (release() == DPS__SUCCEEDED)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int16_t DpsShmReader::wait(uint32_t timeoutMs)
+{
+	uint32_t count = m_header->notifyCount.load(std::memory_order_acquire);
+	if (m_header->writeIndex.load(std::memory_order_acquire) > m_readIndex)
+	{
+		return 1;
+	}
+	struct timespec timeout = {(time_t)(timeoutMs / 1000U), (long)(timeoutMs % 1000U) * 1000000L};
+	//returns at once if the writer has notified since count was read
+	syscall(SYS_futex, &m_header->notifyCount, FUTEX_WAIT, count, &timeout, NULL, 0);
+	return m_header->writeIndex.load(std::memory_order_acquire) > m_readIndex ? 1 : 0;
+}
+
+uint64_t DpsShmReader::getLost(void) const
+{
+	return m_lost;
+}
+
+uint8_t DpsShmReader::isWriterAlive(void) const
+{
+	return m_header->writerPid.load(std::memory_order_acquire) != 0U;
+}
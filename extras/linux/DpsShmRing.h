@@ -0,0 +1,190 @@
+/**
+ * @brief Shared memory ring for distributing samples to many processes
+ *
+ * One writer (the acquisition daemon dpsd) publishes samples into a POSIX shared memory object,
+ * any number of readers map it read-only and consume the samples in place.
+ * Readers never write to the shared memory: they keep their read position locally,
+ * so the latency of a reader does not depend on the number of readers and a slow
+ * reader never blocks the writer.
+ *
+ * Every slot is protected by a sequence number (seqlock): the writer makes it odd while
+ * the slot is written and sets it to 2 * (index + 1) afterwards. A reader checks it before
+ * and after reading the slot; if the writer has lapped the reader in between,
+ * the sample is dropped and counted as lost.
+ * Readers either poll or wait on a futex that the writer signals once per batch.
+ *
+ * @file DpsShmRing.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSSHMRING_H_INCLUDED
+#define DPSSHMRING_H_INCLUDED
+
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+#include "util/dps_config.h"
+
+#define DPS_SHM_MAGIC 0x44505352U // "DPSR"
+#define DPS_SHM_VERSION 1U
+#define DPS_SHM_DEFAULT_NAME "/dps0"
+#define DPS_SHM_DEFAULT_CAPACITY 4096U
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory synchronization requires lock-free 64 bit atomics");
+
+/**
+ * @brief one published result
+ */
+typedef struct
+{
+	uint64_t timestamp; // CLOCK_MONOTONIC in ns
+	float value;        // °C or Pa
+	uint8_t type;       // dps::SampleType_e
+	uint8_t sensor;     // index of the sensor in the daemon
+	uint16_t reserved;
+} DpsSample_t;
+
+/**
+ * @return 	current time in the format of DpsSample_t::timestamp
+ */
+inline uint64_t dpsSampleTime(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief slot of the ring: sample with sequence number
+ */
+typedef struct
+{
+	std::atomic<uint64_t> seq;
+	DpsSample_t sample;
+} DpsShmSlot_t;
+
+/**
+ * @brief start of the shared memory object, followed by capacity slots
+ */
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t slotSize;
+	uint32_t capacity;                 // power of 2
+	uint32_t reserved;
+	std::atomic<uint64_t> writeIndex;  // number of published samples
+	std::atomic<uint32_t> notifyCount; // futex word, incremented by DpsShmWriter::notify()
+	std::atomic<uint32_t> writerPid;   // 0 after the writer has shut down
+} DpsShmHeader_t;
+
+/**
+ * @brief publishes samples; there must be only one writer per ring
+ */
+class DpsShmWriter
+{
+  public:
+	DpsShmWriter(void);
+	~DpsShmWriter(void);
+
+	/**
+	 * creates (or replaces) the shared memory object
+	 *
+	 * @param name:      name of the object, e.g. "/dps0"
+	 * @param capacity:  number of slots, rounded up to a power of 2
+	 * @return  0 on success, negative errno on fail
+	 */
+	int create(const char *name, uint32_t capacity = DPS_SHM_DEFAULT_CAPACITY);
+
+	/**
+	 * unmaps and removes the shared memory object; readers keep their mapping
+	 */
+	void close(void);
+
+	/**
+	 * publishes a sample and makes it visible to all readers
+	 */
+	void publish(const DpsSample_t &sample);
+
+	/**
+	 * wakes up readers waiting in DpsShmReader::wait(), e.g. after publishing a batch of samples
+	 */
+	void notify(void);
+
+  private:
+	DpsShmHeader_t *m_header;
+	DpsShmSlot_t *m_slots;
+	uint32_t m_mask;
+	size_t m_size;
+	char m_name[64];
+};
+
+/**
+ * @brief consumes samples; any number of readers can be attached
+ */
+class DpsShmReader
+{
+  public:
+	DpsShmReader(void);
+	~DpsShmReader(void);
+
+	/**
+	 * maps an existing ring read-only; reading starts with the next published sample
+	 *
+	 * @return  0 on success, negative errno on fail
+	 */
+	int open(const char *name);
+
+	void close(void);
+
+	/**
+	 * returns the next sample in place, without copying it
+	 * The sample is only valid if the following call of release() succeeds.
+	 *
+	 * @return  pointer to the next sample or NULL if there is no new sample
+	 */
+	const DpsSample_t *peek(void);
+
+	/**
+	 * finishes reading the sample returned by peek() and moves to the next one
+	 *
+	 * @return  0 if the sample was valid, -1 if the writer has overwritten it meanwhile
+	 */
+	int16_t release(void);
+
+	/**
+	 * copies the next sample
+	 *
+	 * @return  1 if a sample was read, 0 if there is no new sample
+	 */
+	int16_t read(DpsSample_t &sample);
+
+	/**
+	 * blocks until the writer calls notify() or the timeout expires; returns immediately if there are new samples
+	 *
+	 * @param timeoutMs:  maximum waiting time in ms
+	 * @return  1 if there are new samples, 0 otherwise
+	 */
+	int16_t wait(uint32_t timeoutMs);
+
+	/**
+	 * @return  samples that were overwritten before this reader got them
+	 */
+	uint64_t getLost(void) const;
+
+	/**
+	 * @return  1 while the writer is running, 0 after it has shut down
+	 */
+	uint8_t isWriterAlive(void) const;
+
+  private:
+	const DpsShmHeader_t *m_header;
+	const DpsShmSlot_t *m_slots;
+	uint32_t m_mask;
+	size_t m_size;
+	uint64_t m_readIndex;
+	uint64_t m_seq;
+	uint64_t m_lost;
+};
+
+#endif //DPSSHMRING_H_INCLUDED
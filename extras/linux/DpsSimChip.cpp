@@ -0,0 +1,185 @@
+#include "DpsSimChip.h"
+
+#include <string.h>
+
+DpsSimChip::DpsSimChip(uint8_t chip)
+	: m_chip(chip), m_rawPrs(0), m_rawTemp(0),
+	  m_fifoHead(0U), m_fifoCount(0U), m_failCount(0U), m_transferCount(0U)
+{
+	memset(m_registers, 0, sizeof(m_registers));
+	//product and revision ID
+	if (m_chip == SIM_DPS422)
+	{
+		m_registers[0x1D] = 0x10U | DPS422__PROD_ID;
+	}
+	else
+	{
+		m_registers[0x0D] = 0x10U | DPS310__PROD_ID;
+	}
+	reset();
+}
+
+uint8_t DpsSimChip::getRegister(uint8_t regAddress) const
+{
+	return m_registers[regAddress];
+}
+
+void DpsSimChip::setRegister(uint8_t regAddress, uint8_t data)
+{
+	m_registers[regAddress] = data;
+}
+
+void DpsSimChip::loadBlock(uint8_t regAddress, const uint8_t *data, uint8_t length)
+{
+	for (uint8_t i = 0; i < length; i++)
+	{
+		m_registers[(uint8_t)(regAddress + i)] = data[i];
+	}
+}
+
+void DpsSimChip::setResults(int32_t rawPrs, int32_t rawTemp)
+{
+	m_rawPrs = rawPrs;
+	m_rawTemp = rawTemp;
+}
+
+int16_t DpsSimChip::pushFifo(int32_t raw)
+{
+	if (m_fifoCount >= DPS__FIFO_SIZE)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	m_fifo[(m_fifoHead + m_fifoCount) % DPS__FIFO_SIZE] = raw;
+	m_fifoCount++;
+	updateFifoStatus();
+	return DPS__SUCCEEDED;
+}
+
+void DpsSimChip::failTransfers(uint32_t count)
+{
+	m_failCount = count;
+}
+
+uint32_t DpsSimChip::getTransferCount(void) const
+{
+	return m_transferCount;
+}
+
+int16_t DpsSimChip::startTransfer(void)
+{
+	m_transferCount++;
+	if (m_failCount > 0U)
+	{
+		m_failCount--;
+		return DPS__FAIL_UNKNOWN;
+	}
+	return DPS__SUCCEEDED;
+}
+
+void DpsSimChip::writeRegister(uint8_t regAddress, uint8_t data)
+{
+	uint8_t resetReg = m_chip == SIM_DPS422 ? 0x0D : 0x0C;
+	if (regAddress == dps::MSR_CTRL::regAddress)
+	{
+		//only the measurement control field is writable
+		uint8_t mode = dps::MSR_CTRL::decode(data);
+		uint8_t status = m_registers[regAddress] & ~(dps::MSR_CTRL::mask | dps::TEMP_RDY::mask | dps::PRS_RDY::mask);
+		if (mode == dps::CMD_PRS || mode == dps::CMD_TEMP || mode == dps::CMD_BOTH)
+		{
+			//command mode: results are ready immediately, sensor returns to idle
+			if (mode != dps::CMD_TEMP)
+			{
+				m_registers[0x00] = (uint8_t)(m_rawPrs >> 16);
+				m_registers[0x01] = (uint8_t)(m_rawPrs >> 8);
+				m_registers[0x02] = (uint8_t)m_rawPrs;
+				status |= dps::PRS_RDY::mask;
+			}
+			if (mode != dps::CMD_PRS)
+			{
+				m_registers[0x03] = (uint8_t)(m_rawTemp >> 16);
+				m_registers[0x04] = (uint8_t)(m_rawTemp >> 8);
+				m_registers[0x05] = (uint8_t)m_rawTemp;
+				status |= dps::TEMP_RDY::mask;
+			}
+			//ready interrupts: bits 4 (pressure) and 5 (temperature) of the interrupt select field enable the flags in INT_STS
+			uint8_t flags = (dps::PRS_RDY::decode(status) ? dps::INT_FLAG_PRS::mask : 0U) |
+							(dps::TEMP_RDY::decode(status) ? dps::INT_FLAG_TEMP::mask : 0U);
+			m_registers[dps::INT_FLAG_PRS::regAddress] |= flags & (m_registers[0x09] >> 4);
+			mode = dps::IDLE;
+		}
+		m_registers[regAddress] = status | mode;
+	}
+	else if (regAddress == resetReg)
+	{
+		//FIFO flush
+		if (data & 0x80U)
+		{
+			m_fifoCount = 0U;
+			updateFifoStatus();
+		}
+		//soft reset
+		if ((data & 0x0FU) == 0x09U)
+		{
+			reset();
+		}
+	}
+	else
+	{
+		m_registers[regAddress] = data;
+	}
+}
+
+uint8_t DpsSimChip::readRegister(uint8_t regAddress)
+{
+	//reading the first result register in background mode with enabled FIFO pops the next result
+	if (regAddress == 0x00 && (m_registers[dps::MSR_CTRL::regAddress] & 0x04U) &&
+		dps::FIFO_EN::decode(m_registers[dps::FIFO_EN::regAddress]))
+	{
+		uint32_t raw = 0x800000U;
+		if (m_fifoCount > 0U)
+		{
+			raw = (uint32_t)m_fifo[m_fifoHead] & 0xFFFFFFU;
+			m_fifoHead = (m_fifoHead + 1U) % DPS__FIFO_SIZE;
+			m_fifoCount--;
+			updateFifoStatus();
+		}
+		m_registers[0x00] = (uint8_t)(raw >> 16);
+		m_registers[0x01] = (uint8_t)(raw >> 8);
+		m_registers[0x02] = (uint8_t)raw;
+	}
+	//INT_STS is cleared by reading it
+	if (regAddress == dps::INT_FLAG_PRS::regAddress)
+	{
+		uint8_t intStatus = m_registers[regAddress];
+		m_registers[regAddress] = 0U;
+		return intStatus;
+	}
+	return m_registers[regAddress];
+}
+
+void DpsSimChip::updateFifoStatus(void)
+{
+	uint8_t status = (m_fifoCount == 0U ? 0x01U : 0x00U) | (m_fifoCount >= DPS__FIFO_SIZE ? 0x02U : 0x00U);
+	if (m_chip == SIM_DPS422)
+	{
+		m_registers[0x0C] = status | (uint8_t)(m_fifoCount << 2);
+	}
+	else
+	{
+		m_registers[0x0B] = status;
+	}
+}
+
+void DpsSimChip::reset(void)
+{
+	//configuration and results are cleared, identification and coefficients are kept
+	for (uint8_t i = 0x00; i <= 0x0C; i++)
+	{
+		m_registers[i] = 0U;
+	}
+	m_registers[0x00] = 0x80U; //empty result
+	//coefficients and sensor are ready
+	m_registers[dps::MSR_CTRL::regAddress] = m_chip == SIM_DPS422 ? 0x80U : 0xC0U;
+	m_fifoCount = 0U;
+	updateFifoStatus();
+}
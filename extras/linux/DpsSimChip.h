@@ -0,0 +1,91 @@
+/**
+ * @brief Software model of a DPS310 or DPS422 for host builds
+ *
+ * DpsSimChip holds the register file of one sensor and behaves like it as far as the driver
+ * relies on it: command mode (results, ready flags and ready interrupt status are provided immediately),
+ * FIFO (results queued with pushFifo, 0x800000 when empty), FIFO flush and soft reset.
+ * The bus front ends DpsI2cSim and DpsSpiSim decode their protocol and access it register by register.
+ *
+ * @file DpsSimChip.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSSIMCHIP_H_INCLUDED
+#define DPSSIMCHIP_H_INCLUDED
+
+#include <stdint.h>
+#include "util/dps_config.h"
+
+class DpsSimChip
+{
+  public:
+	enum Chip_e
+	{
+		SIM_DPS310 = 0,
+		SIM_DPS422,
+	};
+
+	explicit DpsSimChip(uint8_t chip = SIM_DPS310);
+
+	uint8_t getRegister(uint8_t regAddress) const;
+	void setRegister(uint8_t regAddress, uint8_t data);
+
+	/**
+	 * writes consecutive registers, e.g. to load calibration coefficients
+	 */
+	void loadBlock(uint8_t regAddress, const uint8_t *data, uint8_t length);
+
+	/**
+	 * sets the raw results returned by command mode measurements
+	 */
+	void setResults(int32_t rawPrs, int32_t rawTemp);
+
+	/**
+	 * appends a raw result to the FIFO; the LSB marks pressure (1) or temperature (0)
+	 *
+	 * @return 	0 on success, -1 if the FIFO is full
+	 */
+	int16_t pushFifo(int32_t raw);
+
+	/**
+	 * makes the next transfers fail, e.g. to simulate a disturbed bus
+	 *
+	 * @param count: 	number of transfers that fail
+	 */
+	void failTransfers(uint32_t count);
+
+	/**
+	 * @return 	number of transfers (ioctl calls on a real adapter) since construction
+	 */
+	uint32_t getTransferCount(void) const;
+
+  protected:
+	/**
+	 * counts a transfer of the bus front end
+	 *
+	 * @return 	0 if the transfer is executed, -1 if it has to fail
+	 */
+	int16_t startTransfer(void);
+
+	/**
+	 * register access as seen from the bus, with all side effects
+	 */
+	void writeRegister(uint8_t regAddress, uint8_t data);
+	uint8_t readRegister(uint8_t regAddress);
+
+  private:
+	void updateFifoStatus(void);
+	void reset(void);
+
+	uint8_t m_chip;
+	uint8_t m_registers[256];
+	int32_t m_rawPrs;
+	int32_t m_rawTemp;
+	int32_t m_fifo[DPS__FIFO_SIZE];
+	uint8_t m_fifoHead;
+	uint8_t m_fifoCount;
+	uint32_t m_failCount;
+	uint32_t m_transferCount;
+};
+
+#endif //DPSSIMCHIP_H_INCLUDED
@@ -0,0 +1,396 @@
+#include <string.h>
+#include <new>
+
+#include "dps_capi.h"
+#include "Dps310.h"
+#include "Dps422.h"
+
+/**
+ * @brief what the C interface needs from a compensator; the loops run behind one virtual call per batch
+ */
+struct dps_compensator
+{
+	virtual ~dps_compensator(void) {}
+
+	virtual void setOversampling(uint8_t tempOsr, uint8_t prsOsr) = 0;
+	virtual int16_t applyTrim(const uint8_t *trim, uint8_t length) = 0;
+
+	virtual void fifo(const int32_t *raw, size_t count, float *out) = 0;
+	virtual void fifo(const int32_t *raw, size_t count, int32_t *out) = 0;
+	virtual void temp(const int32_t *raw, size_t count, float *out) = 0;
+	virtual void temp(const int32_t *raw, size_t count, int32_t *out) = 0;
+	virtual void pressure(const int32_t *raw, size_t count, float *out) = 0;
+	virtual void pressure(const int32_t *raw, size_t count, int32_t *out) = 0;
+	virtual void pairs(const int32_t *rawTemp, const int32_t *rawPrs, size_t count, float *temp, float *prs) = 0;
+	virtual void pairs(const int32_t *rawTemp, const int32_t *rawPrs, size_t count, int32_t *temp, int32_t *prs) = 0;
+};
+
+namespace
+{
+
+/**
+ * @brief register layout of the coefficient blobs
+ */
+template <class Chip>
+struct Blob;
+
+template <>
+struct Blob<Dps310>
+{
+	typedef dps310::PROD_ID ProdId;
+	typedef dps310::REV_ID RevId;
+	static const uint8_t initAddress = 0x0D;
+	static const uint8_t initLength = DPS310__INIT_BLOCK_LENGTH;
+	static const uint8_t coeffAddress = 0x10;
+	static const uint8_t coeffLength = 18U;
+};
+
+template <>
+struct Blob<Dps422>
+{
+	typedef dps422::PROD_ID ProdId;
+	typedef dps422::REV_ID RevId;
+	static const uint8_t initAddress = 0x1D;
+	static const uint8_t initLength = DPS422__INIT_BLOCK_LENGTH;
+	//both coefficient blocks with the 3 registers between them
+	static const uint8_t coeffAddress = 0x20;
+	static const uint8_t coeffLength = 26U;
+};
+
+template <class Comp, class Result>
+void compensateFifo(Comp comp, const int32_t *raw, size_t count, Result *out)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = (raw[i] & 0x01) ? comp.calcPressure(raw[i]) : comp.calcTemp(raw[i]);
+	}
+}
+
+template <class Comp, class Result>
+void compensateTemp(Comp comp, const int32_t *raw, size_t count, Result *out)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = comp.calcTemp(raw[i]);
+	}
+}
+
+template <class Comp, class Result>
+void compensatePressure(Comp comp, const int32_t *raw, size_t count, Result *out)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = comp.calcPressure(raw[i]);
+	}
+}
+
+template <class Comp, class Result>
+void compensatePairs(Comp comp, const int32_t *rawTemp, const int32_t *rawPrs, size_t count, Result *temp, Result *prs)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		Result t = comp.calcTemp(rawTemp[i]);
+		if (temp != NULL)
+		{
+			temp[i] = t;
+		}
+		prs[i] = comp.calcPressure(rawPrs[i]);
+	}
+}
+
+/**
+ * @brief a sensor that is never connected: the coefficients come from a blob, the compensation is the driver's
+ */
+template <class Chip>
+class Compensator : public dps_compensator, public Chip
+{
+	typedef Blob<Chip> Layout;
+
+  public:
+	/**
+	 * @return 	0 on success, -1 if the length fits neither layout
+	 */
+	int16_t load(const uint8_t *coeffs, size_t length)
+	{
+		uint8_t snapshot[Layout::initLength];
+		memset(snapshot, 0, sizeof(snapshot));
+		if (length == Layout::initLength)
+		{
+			memcpy(snapshot, coeffs, length);
+		}
+		else if (length == Layout::coeffLength)
+		{
+			memcpy(snapshot + (Layout::coeffAddress - Layout::initAddress), coeffs, length);
+		}
+		else
+		{
+			return DPS__FAIL_UNKNOWN;
+		}
+		this->m_productID = Layout::ProdId::decode(snapshot[Layout::ProdId::regAddress - Layout::initAddress]);
+		this->m_revisionID = Layout::RevId::decode(snapshot[Layout::RevId::regAddress - Layout::initAddress]);
+		setOversampling(DPS__OVERSAMPLING_RATE_8, DPS__OVERSAMPLING_RATE_8);
+		return this->readcoeffs(snapshot);
+	}
+
+	void setOversampling(uint8_t tempOsr, uint8_t prsOsr)
+	{
+		//calcPressure folds the polynomial again for another oversampling rate
+		this->m_tempOsr = tempOsr;
+		this->m_prsOsr = prsOsr;
+	}
+
+	int16_t applyTrim(const uint8_t *trim, uint8_t length)
+	{
+		return this->loadTrim(trim, length);
+	}
+
+	void fifo(const int32_t *raw, size_t count, float *out)
+	{
+		compensateFifo(FloatComp(*this), raw, count, out);
+	}
+
+	void fifo(const int32_t *raw, size_t count, int32_t *out)
+	{
+		compensateFifo(IntComp(*this), raw, count, out);
+	}
+
+	void temp(const int32_t *raw, size_t count, float *out)
+	{
+		compensateTemp(FloatComp(*this), raw, count, out);
+	}
+
+	void temp(const int32_t *raw, size_t count, int32_t *out)
+	{
+		compensateTemp(IntComp(*this), raw, count, out);
+	}
+
+	void pressure(const int32_t *raw, size_t count, float *out)
+	{
+		compensatePressure(FloatComp(*this), raw, count, out);
+	}
+
+	void pressure(const int32_t *raw, size_t count, int32_t *out)
+	{
+		compensatePressure(IntComp(*this), raw, count, out);
+	}
+
+	void pairs(const int32_t *rawTemp, const int32_t *rawPrs, size_t count, float *temp, float *prs)
+	{
+		compensatePairs(FloatComp(*this), rawTemp, rawPrs, count, temp, prs);
+	}
+
+	void pairs(const int32_t *rawTemp, const int32_t *rawPrs, size_t count, int32_t *temp, int32_t *prs)
+	{
+		compensatePairs(IntComp(*this), rawTemp, rawPrs, count, temp, prs);
+	}
+
+  private:
+	/**
+	 * calls the compensation of the chip without virtual dispatch, like DpsSensor
+	 */
+	struct FloatComp
+	{
+		explicit FloatComp(Compensator &sensor) : m_sensor(sensor) {}
+
+		float calcTemp(int32_t raw)
+		{
+			return m_sensor.Chip::calcTemp(raw);
+		}
+
+		float calcPressure(int32_t raw)
+		{
+			return m_sensor.Chip::calcPressure(raw);
+		}
+
+		Compensator &m_sensor;
+	};
+
+	struct IntComp
+	{
+		explicit IntComp(Compensator &sensor) : m_sensor(sensor) {}
+
+		int32_t calcTemp(int32_t raw)
+		{
+			return m_sensor.Chip::calcTempInt(raw);
+		}
+
+		int32_t calcPressure(int32_t raw)
+		{
+			return m_sensor.Chip::calcPressureInt(raw);
+		}
+
+		Compensator &m_sensor;
+	};
+};
+
+template <class Chip>
+dps_compensator *create(const uint8_t *coeffs, size_t length)
+{
+	Compensator<Chip> *comp = new (std::nothrow) Compensator<Chip>();
+	if (comp != NULL && comp->load(coeffs, length) != DPS__SUCCEEDED)
+	{
+		delete comp;
+		comp = NULL;
+	}
+	return comp;
+}
+
+/**
+ * @return 	1 if comp and the arrays can be used
+ */
+int valid(const dps_compensator *comp, const void *in, const void *out, size_t count)
+{
+	return comp != NULL && (count == 0U || (in != NULL && out != NULL));
+}
+
+/**
+ * @return 	1 if all raw values fit the 24 bit result registers, as the compensation requires
+ */
+int rawValid(const int32_t *raw, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (raw[i] < -DPS_CAPI_RAW_LIMIT || raw[i] >= DPS_CAPI_RAW_LIMIT)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+} // namespace
+
+extern "C" {
+
+int dps_capi_version(void)
+{
+	return DPS_CAPI_VERSION;
+}
+
+dps_compensator *dps_compensator_create(int chip, const uint8_t *coeffs, size_t length)
+{
+	if (coeffs == NULL)
+	{
+		return NULL;
+	}
+	switch (chip)
+	{
+	case DPS_CAPI_DPS310:
+		return create<Dps310>(coeffs, length);
+	case DPS_CAPI_DPS422:
+		return create<Dps422>(coeffs, length);
+	default:
+		return NULL;
+	}
+}
+
+void dps_compensator_destroy(dps_compensator *comp)
+{
+	delete comp;
+}
+
+int dps_set_oversampling(dps_compensator *comp, int temp_osr, int prs_osr)
+{
+	if (comp == NULL || temp_osr < 0 || temp_osr > DPS__OVERSAMPLING_RATE_128 ||
+		prs_osr < 0 || prs_osr > DPS__OVERSAMPLING_RATE_128)
+	{
+		return DPS_CAPI_FAIL;
+	}
+	comp->setOversampling((uint8_t)temp_osr, (uint8_t)prs_osr);
+	return DPS_CAPI_OK;
+}
+
+int dps_load_trim(dps_compensator *comp, const uint8_t *trim, size_t length)
+{
+	if (comp == NULL || trim == NULL || length > 0xFFU)
+	{
+		return DPS_CAPI_FAIL;
+	}
+	return comp->applyTrim(trim, (uint8_t)length) == DPS__SUCCEEDED ? DPS_CAPI_OK : DPS_CAPI_FAIL;
+}
+
+int dps_compensate_fifo(dps_compensator *comp, const int32_t *raw, size_t count, float *out)
+{
+	if (!valid(comp, raw, out, count) || !rawValid(raw, count))
+	{
+		return DPS_CAPI_FAIL;
+	}
+	comp->fifo(raw, count, out);
+	return DPS_CAPI_OK;
+}
+
+int dps_compensate_fifo_int(dps_compensator *comp, const int32_t *raw, size_t count, int32_t *out)
+{
+	if (!valid(comp, raw, out, count) || !rawValid(raw, count))
+	{
+		return DPS_CAPI_FAIL;
+	}
+	comp->fifo(raw, count, out);
+	return DPS_CAPI_OK;
+}
+
+int dps_compensate_temp(dps_compensator *comp, const int32_t *raw, size_t count, float *out)
+{
+	if (!valid(comp, raw, out, count) || !rawValid(raw, count))
+	{
+		return DPS_CAPI_FAIL;
+	}
+	comp->temp(raw, count, out);
+	return DPS_CAPI_OK;
+}
+
+int dps_compensate_temp_int(dps_compensator *comp, const int32_t *raw, size_t count, int32_t *out)
+{
+	if (!valid(comp, raw, out, count) || !rawValid(raw, count))
+	{
+		return DPS_CAPI_FAIL;
+	}
+	comp->temp(raw, count, out);
+	return DPS_CAPI_OK;
+}
+
+int dps_compensate_pressure(dps_compensator *comp, const int32_t *raw, size_t count, float *out)
+{
+	if (!valid(comp, raw, out, count) || !rawValid(raw, count))
+	{
+		return DPS_CAPI_FAIL;
+	}
+	comp->pressure(raw, count, out);
+	return DPS_CAPI_OK;
+}
+
+int dps_compensate_pressure_int(dps_compensator *comp, const int32_t *raw, size_t count, int32_t *out)
+{
+	if (!valid(comp, raw, out, count) || !rawValid(raw, count))
+	{
+		return DPS_CAPI_FAIL;
+	}
+	comp->pressure(raw, count, out);
+	return DPS_CAPI_OK;
+}
+
+int dps_compensate_pairs(dps_compensator *comp, const int32_t *raw_temp, const int32_t *raw_prs,
+						 size_t count, float *temp, float *prs)
+{
+	if (!valid(comp, raw_temp, prs, count) || (count > 0U && raw_prs == NULL) ||
+		!rawValid(raw_temp, count) || !rawValid(raw_prs, count))
+	{
+		return DPS_CAPI_FAIL;
+	}
+	comp->pairs(raw_temp, raw_prs, count, temp, prs);
+	return DPS_CAPI_OK;
+}
+
+int dps_compensate_pairs_int(dps_compensator *comp, const int32_t *raw_temp, const int32_t *raw_prs,
+							 size_t count, int32_t *temp, int32_t *prs)
+{
+	if (!valid(comp, raw_temp, prs, count) || (count > 0U && raw_prs == NULL) ||
+		!rawValid(raw_temp, count) || !rawValid(raw_prs, count))
+	{
+		return DPS_CAPI_FAIL;
+	}
+	comp->pairs(raw_temp, raw_prs, count, temp, prs);
+	return DPS_CAPI_OK;
+}
+
+} // extern "C"
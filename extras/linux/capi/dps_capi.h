@@ -0,0 +1,145 @@
+/**
+ * @brief C interface to the compensation of the driver, for use from other languages
+ *
+ * A compensator holds the calibration coefficients of one sensor and turns raw results into
+ * °C and Pa with the same code as the driver (Dps310/Dps422 calcTemp, calcPressure and their
+ * integer versions, including a trim). The functions work on whole arrays, so callers through
+ * a foreign function interface pay one call per batch, not per result.
+ *
+ * The coefficients are passed as the register content the sensor returns, either
+ *  - the init block (DPS310 0x0D..0x28, DPS422 0x1D..0x39), which includes the product and revision ID
+ *    needed by dps_load_trim, or
+ *  - the coefficient registers alone (DPS310 0x10..0x21, DPS422 0x20..0x39), as used by dpsbench.
+ *
+ * Raw values are the sign extended 24 bit register content, -2^23 to 2^23 - 1 (DPS_CAPI_RAW_LIMIT).
+ * The compensation functions check this before they write any result and fail with DPS_CAPI_FAIL
+ * if a value is outside, instead of masking it: such a value did not come from a sensor.
+ *
+ * Like the driver, a pressure is compensated with the temperature compensated last on the same
+ * compensator. A compensator must not be used by several threads at the same time;
+ * different compensators are independent.
+ *
+ * Built as shared library libdps.so with the Makefile next to this file.
+ *
+ * @file dps_capi.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPS_CAPI_H_INCLUDED
+#define DPS_CAPI_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define DPS_CAPI_EXPORT __attribute__((visibility("default")))
+#else
+#define DPS_CAPI_EXPORT
+#endif
+
+//incremented when a function is added; existing functions and their behaviour are kept
+#define DPS_CAPI_VERSION 1
+
+//status codes
+#define DPS_CAPI_OK 0
+#define DPS_CAPI_FAIL -1
+
+//raw values are in -DPS_CAPI_RAW_LIMIT .. DPS_CAPI_RAW_LIMIT - 1
+#define DPS_CAPI_RAW_LIMIT 8388608
+
+//chips
+#define DPS_CAPI_DPS310 310
+#define DPS_CAPI_DPS422 422
+
+typedef struct dps_compensator dps_compensator;
+
+/**
+ * @return 	DPS_CAPI_VERSION of the library, which may be newer than the header
+ */
+DPS_CAPI_EXPORT int dps_capi_version(void);
+
+/**
+ * creates a compensator with oversampling rate 8 (DPS__OVERSAMPLING_RATE_8) for both results
+ *
+ * @param chip: 		DPS_CAPI_DPS310 or DPS_CAPI_DPS422
+ * @param coeffs: 	register content, see above
+ * @param length: 	28 or 18 bytes for the DPS310, 29 or 26 bytes for the DPS422
+ * @return 	the compensator, NULL if chip or length are invalid or there is no memory
+ */
+DPS_CAPI_EXPORT dps_compensator *dps_compensator_create(int chip, const uint8_t *coeffs, size_t length);
+
+DPS_CAPI_EXPORT void dps_compensator_destroy(dps_compensator *comp);
+
+/**
+ * sets the oversampling rates the raw results were measured with
+ *
+ * @param temp_osr: 	0 (single) to 7 (128 times)
+ * @param prs_osr: 	0 (single) to 7 (128 times)
+ * @return 	status code
+ */
+DPS_CAPI_EXPORT int dps_set_oversampling(dps_compensator *comp, int temp_osr, int prs_osr);
+
+/**
+ * applies a trim saved by DpsClass::saveTrim (DPS__TRIM_BLOB_LENGTH bytes)
+ *
+ * @return 	status code, DPS_CAPI_FAIL if the trim is damaged or belongs to a sensor with another
+ * 			product or revision ID than the coefficients (which need the init block for this)
+ */
+DPS_CAPI_EXPORT int dps_load_trim(dps_compensator *comp, const uint8_t *trim, size_t length);
+
+/**
+ * compensates raw results in FIFO order, as returned by getContRawResults:
+ * the LSB of each raw value marks a pressure (1) or a temperature (0)
+ *
+ * @param raw: 		count raw results
+ * @param out: 		count results in °C or Pa
+ * @return 	status code, DPS_CAPI_FAIL without results if a raw value is out of range
+ */
+DPS_CAPI_EXPORT int dps_compensate_fifo(dps_compensator *comp, const int32_t *raw, size_t count, float *out);
+
+/**
+ * like dps_compensate_fifo, results in 0.001 °C and 0.01 Pa without float arithmetic
+ */
+DPS_CAPI_EXPORT int dps_compensate_fifo_int(dps_compensator *comp, const int32_t *raw, size_t count, int32_t *out);
+
+/**
+ * compensates temperature raw results; the last one is used for the following pressures
+ */
+DPS_CAPI_EXPORT int dps_compensate_temp(dps_compensator *comp, const int32_t *raw, size_t count, float *out);
+
+DPS_CAPI_EXPORT int dps_compensate_temp_int(dps_compensator *comp, const int32_t *raw, size_t count, int32_t *out);
+
+/**
+ * compensates pressure raw results with the temperature compensated last
+ */
+DPS_CAPI_EXPORT int dps_compensate_pressure(dps_compensator *comp, const int32_t *raw, size_t count, float *out);
+
+DPS_CAPI_EXPORT int dps_compensate_pressure_int(dps_compensator *comp, const int32_t *raw, size_t count, int32_t *out);
+
+/**
+ * compensates pairs of results, each pressure with the temperature of its pair
+ *
+ * @param raw_temp: 	count temperature raw results
+ * @param raw_prs: 	count pressure raw results
+ * @param temp: 		count temperatures in °C, may be NULL
+ * @param prs: 		count pressures in Pa
+ * @return 	status code, DPS_CAPI_FAIL without results if a raw value is out of range
+ */
+DPS_CAPI_EXPORT int dps_compensate_pairs(dps_compensator *comp, const int32_t *raw_temp, const int32_t *raw_prs,
+										 size_t count, float *temp, float *prs);
+
+/**
+ * like dps_compensate_pairs, results in 0.001 °C and 0.01 Pa without float arithmetic
+ */
+DPS_CAPI_EXPORT int dps_compensate_pairs_int(dps_compensator *comp, const int32_t *raw_temp, const int32_t *raw_prs,
+											 size_t count, int32_t *temp, int32_t *prs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //DPS_CAPI_H_INCLUDED
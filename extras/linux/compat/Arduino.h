@@ -0,0 +1,47 @@
+/**
+ * Minimal Arduino API for building the library on Linux hosts
+ *
+ * Only what the library itself uses is provided. Host builds use DPS_DISABLESPI
+ * and connect sensors through a DpsTransport (see DpsLinuxI2c.h).
+ */
+
+#ifndef DPS_LINUX_ARDUINO_H_INCLUDED
+#define DPS_LINUX_ARDUINO_H_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+inline unsigned long micros(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long)now.tv_sec * 1000000UL + (unsigned long)now.tv_nsec / 1000UL;
+}
+
+inline unsigned long millis(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long)now.tv_sec * 1000UL + (unsigned long)now.tv_nsec / 1000000UL;
+}
+
+inline void delayMicroseconds(unsigned int us)
+{
+	struct timespec duration = {(time_t)(us / 1000000U), (long)(us % 1000000U) * 1000L};
+	while (nanosleep(&duration, &duration) != 0)
+	{
+	}
+}
+
+inline void delay(unsigned long ms)
+{
+	struct timespec duration = {(time_t)(ms / 1000UL), (long)(ms % 1000UL) * 1000000L};
+	while (nanosleep(&duration, &duration) != 0)
+	{
+	}
+}
+
+#endif //DPS_LINUX_ARDUINO_H_INCLUDED
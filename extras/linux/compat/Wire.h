@@ -0,0 +1,25 @@
+/**
+ * Placeholder for the Arduino TwoWire class on Linux hosts
+ *
+ * DpsClass::begin(TwoWire &) is not usable on Linux; every transfer fails.
+ * Use DpsClass::begin(DpsTransport &) with DpsLinuxI2c instead.
+ */
+
+#ifndef DPS_LINUX_WIRE_H_INCLUDED
+#define DPS_LINUX_WIRE_H_INCLUDED
+
+#include "Arduino.h"
+
+class TwoWire
+{
+  public:
+	void begin(void) {}
+	void end(void) {}
+	void beginTransmission(uint8_t) {}
+	size_t write(uint8_t) { return 0; }
+	uint8_t endTransmission(uint8_t = 1) { return 4; } //other error
+	uint8_t requestFrom(uint8_t, uint8_t, uint8_t = 1) { return 0; }
+	int read(void) { return -1; }
+};
+
+#endif //DPS_LINUX_WIRE_H_INCLUDED
@@ -0,0 +1,645 @@
+/**
+ * @brief dpsbench - accuracy and speed of the compensation paths
+ *
+ * Runs the compensation of the driver over a corpus of coefficient sets, for all 8 oversampling rates,
+ * pressure raw values over the whole 24 bit range and temperatures of -40, 25 and 85 °C.
+ * Each result is compared with a reference in double precision that decodes the coefficients from the
+ * register bytes on its own. For each path, the maximum and RMS error and the time per result are reported.
+ *
+ * usage: dpsbench [-f <corpus file>] [-n] [-s <raw step>] [-r <max error in range>] [-m <max error>]
+ *
+ * The exit status is 1 if a coefficient set cannot be initialized or a path exceeds the error limits:
+ * -r for pressures between BENCH_RANGE_MIN and BENCH_RANGE_MAX, -m over the whole raw range (both in Pa).
+ *
+ * Corpus file: one coefficient set per line, "310 <36 hex digits>" with the registers 0x10 ... 0x21
+ * or "422 <52 hex digits>" with the registers 0x20 ... 0x39, e.g. from i2cdump. '#' starts a comment.
+ * The built-in sets have typical magnitudes; -n leaves them out.
+ *
+ * @file dpsbench.cpp
+ * @author Infineon Technologies
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Dps310.h"
+#include "Dps422.h"
+#include "DpsLinuxI2c.h"
+
+#define BENCH_MAX_SETS 32U
+#define BENCH_MAX_REGS 26U
+//minimum duration of a timing loop in ns
+#define BENCH_MIN_TIME 20000000ULL
+#define BENCH_TIMING_TEMPS 1024U
+//pressure range of the sensor in Pa, errors inside are reported separately
+#define BENCH_RANGE_MIN 30000.0
+#define BENCH_RANGE_MAX 120000.0
+#define BENCH_INT_PRS_LIMIT ((double)INT32_MAX / DPS__INT_PRS_SCALE)
+//default error limits in Pa, a few times the errors of float compensation
+#define BENCH_MAX_ERROR_RANGE 0.1
+#define BENCH_MAX_ERROR 50.0
+
+enum Impl_e
+{
+	IMPL_FLOAT,	   // calcTemp/calcPressure, temperature folded into the pressure polynomial
+	IMPL_UNFOLDED, // the full polynomial in float for each pressure
+	IMPL_INT,	   // calcTempInt/calcPressureInt
+	IMPL_COUNT,
+};
+
+static const char *const implNames[IMPL_COUNT] = {"float", "float-unfolded", "int"};
+
+static const int8_t benchTemps[] = {-40, 25, 85};
+
+struct CoefSet_t
+{
+	uint16_t chip;
+	char name[24];
+	uint8_t regs[BENCH_MAX_REGS];
+};
+
+struct Limits_t
+{
+	double maxInRange;
+	double max;
+};
+
+struct Error_t
+{
+	double max;
+	double maxInRange;
+	double sumSquares;
+	uint32_t count;
+	double maxTemp;
+};
+
+static volatile float s_sinkFloat;
+static volatile int32_t s_sinkInt;
+
+static uint64_t now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int32_t twosComplement(uint32_t raw, uint8_t length)
+{
+	return (raw & ((uint32_t)1 << (length - 1))) ? (int32_t)raw - ((int32_t)1 << length) : (int32_t)raw;
+}
+
+static int32_t clampRaw(double raw)
+{
+	if (raw > 8388607.0)
+	{
+		return 8388607;
+	}
+	if (raw < -8388608.0)
+	{
+		return -8388608;
+	}
+	return (int32_t)floor(raw + 0.5);
+}
+
+/**
+ * @brief DPS310 compensation from the datasheet in double precision
+ */
+class Ref310
+{
+  public:
+	explicit Ref310(const uint8_t *regs)
+	{
+		int32_t c0 = twosComplement(((uint32_t)regs[0] << 4) | (regs[1] >> 4), 12);
+		//the driver halves c0 as integer
+		m_c0Half = c0 / 2;
+		m_c1 = twosComplement(((uint32_t)(regs[1] & 0x0F) << 8) | regs[2], 12);
+		m_c00 = twosComplement(((uint32_t)regs[3] << 12) | ((uint32_t)regs[4] << 4) | (regs[5] >> 4), 20);
+		m_c10 = twosComplement(((uint32_t)(regs[5] & 0x0F) << 16) | ((uint32_t)regs[6] << 8) | regs[7], 20);
+		m_c01 = twosComplement(((uint32_t)regs[8] << 8) | regs[9], 16);
+		m_c11 = twosComplement(((uint32_t)regs[10] << 8) | regs[11], 16);
+		m_c20 = twosComplement(((uint32_t)regs[12] << 8) | regs[13], 16);
+		m_c21 = twosComplement(((uint32_t)regs[14] << 8) | regs[15], 16);
+		m_c30 = twosComplement(((uint32_t)regs[16] << 8) | regs[17], 16);
+	}
+
+	int32_t rawTemp(double temp, uint8_t osr) const
+	{
+		return clampRaw((temp - m_c0Half) / m_c1 * dps::scalingFactor(osr));
+	}
+
+	double temp(int32_t raw, uint8_t osr)
+	{
+		m_tsc = (double)raw / dps::scalingFactor(osr);
+		return m_c0Half + m_c1 * m_tsc;
+	}
+
+	double pressure(int32_t raw, uint8_t osr) const
+	{
+		double p = (double)raw / dps::scalingFactor(osr);
+		return m_c00 + p * (m_c10 + p * (m_c20 + p * m_c30)) + m_tsc * (m_c01 + p * (m_c11 + p * m_c21));
+	}
+
+  private:
+	double m_c0Half, m_c1, m_c00, m_c10, m_c01, m_c11, m_c20, m_c21, m_c30;
+	double m_tsc;
+};
+
+/**
+ * @brief DPS422 compensation from the datasheet in double precision
+ */
+class Ref422
+{
+  public:
+	explicit Ref422(const uint8_t *regs)
+	{
+		//temperature coefficients at 0x20, pressure coefficients at 0x26
+		double gain = twosComplement(regs[0], 8);
+		double dVbe = twosComplement(regs[1] >> 1, 7);
+		double vbe = twosComplement((regs[1] & 0x01) | ((uint32_t)regs[2] << 1), 9);
+		double aadc = gain * 8.4375e-5 + 0.675;
+		double vbeCal = (vbe * 1.05031e-4 + 0.463232422) / aadc;
+		double dVbeCal = (dVbe * 1.25885e-5 + 0.04027621) / aadc;
+		double tCalib = DPS422_A_0 * dVbeCal - 273.15;
+		double vbeCalTref = vbeCal - (tCalib - DPS422_T_REF) * DPS422_T_C_VBE;
+		double kPtat = (DPS422_V_BE_TARGET - vbeCalTref) * DPS422_K_PTAT_CORNER + DPS422_K_PTAT_CURVATURE;
+		m_aPrime = DPS422_A_0 * (vbeCal + DPS422_ALPHA * dVbeCal) * (1 + kPtat);
+		m_bPrime = -273.15 * (1 + kPtat) - kPtat * tCalib;
+
+		const uint8_t *b = regs + 6;
+		m_c00 = twosComplement(((uint32_t)b[0] << 12) | ((uint32_t)b[1] << 4) | (b[2] >> 4), 20);
+		m_c10 = twosComplement(((uint32_t)(b[2] & 0x0F) << 16) | ((uint32_t)b[3] << 8) | b[4], 20);
+		m_c01 = twosComplement(((uint32_t)b[5] << 12) | ((uint32_t)b[6] << 4) | (b[7] >> 4), 20);
+		m_c02 = twosComplement(((uint32_t)(b[7] & 0x0F) << 16) | ((uint32_t)b[8] << 8) | b[9], 20);
+		m_c20 = twosComplement(((uint32_t)(b[10] & 0x7F) << 8) | b[11], 15);
+		m_c30 = twosComplement(((uint32_t)(b[12] & 0x0F) << 8) | b[13], 12);
+		m_c11 = twosComplement(((uint32_t)b[14] << 9) | ((uint32_t)b[15] << 1) | (b[16] >> 7), 17);
+		m_c12 = twosComplement(((uint32_t)(b[16] & 0x7F) << 10) | ((uint32_t)b[17] << 2) | (b[18] >> 6), 17);
+		m_c21 = twosComplement(((uint32_t)(b[18] & 0x3F) << 8) | b[19], 14);
+	}
+
+	int32_t rawTemp(double temp, uint8_t osr) const
+	{
+		//the temperature result of the DPS422 does not depend on the oversampling rate
+		(void)osr;
+		double u = (temp - m_bPrime) / m_aPrime;
+		return clampRaw(u / (1 - DPS422_ALPHA * u) * 1048576.0);
+	}
+
+	double temp(int32_t raw, uint8_t osr)
+	{
+		(void)osr;
+		double tsc = (double)raw / 1048576.0;
+		m_t = 8.5 * tsc / (1 + 8.8 * tsc);
+		return m_aPrime * tsc / (1 + DPS422_ALPHA * tsc) + m_bPrime;
+	}
+
+	double pressure(int32_t raw, uint8_t osr) const
+	{
+		double p = (double)raw / dps::scalingFactor(osr);
+		double t = m_t;
+		return m_c00 + t * (m_c01 + t * m_c02) + p * (m_c10 + t * (m_c11 + t * m_c12) + p * (m_c20 + t * m_c21 + p * m_c30));
+	}
+
+  private:
+	double m_aPrime, m_bPrime;
+	double m_c00, m_c10, m_c01, m_c02, m_c20, m_c30, m_c11, m_c12, m_c21;
+	double m_t;
+};
+
+/**
+ * @brief DPS310 with access to its compensation paths
+ */
+class Bench310 : public Dps310
+{
+  public:
+	using Dps310::calcPressure;
+	using Dps310::calcPressureInt;
+	using Dps310::calcTemp;
+	using Dps310::calcTempInt;
+
+	uint8_t initFailed(void) const
+	{
+		return m_initFail;
+	}
+
+	void setOsr(uint8_t osr)
+	{
+		m_tempOsr = osr;
+		m_prsOsr = osr;
+	}
+
+	float calcPressureUnfolded(int32_t raw)
+	{
+		float p = (float)raw / scaling_facts[m_prsOsr];
+		float t = m_lastTempScal;
+		return m_k.c00 + p * (m_k.c10 + p * (m_k.c20 + p * m_k.c30)) + t * (m_k.c01 + p * (m_k.c11 + p * m_k.c21));
+	}
+};
+
+/**
+ * @brief DPS422 with access to its compensation paths
+ */
+class Bench422 : public Dps422
+{
+  public:
+	using Dps422::calcPressure;
+	using Dps422::calcPressureInt;
+	using Dps422::calcTemp;
+	using Dps422::calcTempInt;
+
+	uint8_t initFailed(void) const
+	{
+		return m_initFail;
+	}
+
+	void setOsr(uint8_t osr)
+	{
+		m_tempOsr = osr;
+		m_prsOsr = osr;
+	}
+
+	float calcPressureUnfolded(int32_t raw)
+	{
+		float p = (float)raw / scaling_facts[m_prsOsr];
+		float t = (8.5f * m_lastTempScal) / (1 + 8.8f * m_lastTempScal);
+		return m_k.c00 + t * (m_k.c01 + t * m_k.c02) + p * (m_k.c10 + t * (m_k.c11 + t * m_k.c12) + p * (m_k.c20 + t * m_k.c21 + p * m_k.c30));
+	}
+};
+
+template <class Bench>
+static double compensateTemp(Bench &sensor, uint8_t impl, int32_t raw)
+{
+	if (impl == IMPL_INT)
+	{
+		return (double)sensor.calcTempInt(raw) / DPS__INT_TEMP_SCALE;
+	}
+	return sensor.calcTemp(raw);
+}
+
+template <class Bench>
+static double compensatePressure(Bench &sensor, uint8_t impl, int32_t raw)
+{
+	switch (impl)
+	{
+	case IMPL_FLOAT:
+		return sensor.calcPressure(raw);
+	case IMPL_UNFOLDED:
+		return sensor.calcPressureUnfolded(raw);
+	default:
+		return (double)sensor.calcPressureInt(raw) / DPS__INT_PRS_SCALE;
+	}
+}
+
+/**
+ * @return 	time per pressure result in ns; the path is selected outside the loop, so the calls can be inlined
+ */
+template <class Bench>
+static double timePressure(Bench &sensor, uint8_t impl, const int32_t *raw, uint32_t count)
+{
+	float sumFloat = 0.0f;
+	int32_t sumInt = 0;
+	uint64_t results = 0U;
+	uint64_t start = now();
+	uint64_t elapsed;
+	do
+	{
+		switch (impl)
+		{
+		case IMPL_FLOAT:
+			for (uint32_t i = 0; i < count; i++)
+			{
+				sumFloat += sensor.calcPressure(raw[i]);
+			}
+			break;
+		case IMPL_UNFOLDED:
+			for (uint32_t i = 0; i < count; i++)
+			{
+				sumFloat += sensor.calcPressureUnfolded(raw[i]);
+			}
+			break;
+		default:
+			for (uint32_t i = 0; i < count; i++)
+			{
+				sumInt += sensor.calcPressureInt(raw[i]);
+			}
+			break;
+		}
+		results += count;
+		elapsed = now() - start;
+	} while (elapsed < BENCH_MIN_TIME);
+	s_sinkFloat = sumFloat;
+	s_sinkInt = sumInt;
+	return (double)elapsed / results;
+}
+
+/**
+ * @return 	time per temperature result in ns, including what the path prepares for the next pressures
+ */
+template <class Bench>
+static double timeTemp(Bench &sensor, uint8_t impl, const int32_t *raw, uint32_t count)
+{
+	float sumFloat = 0.0f;
+	int32_t sumInt = 0;
+	uint64_t results = 0U;
+	uint64_t start = now();
+	uint64_t elapsed;
+	do
+	{
+		if (impl == IMPL_INT)
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				sumInt += sensor.calcTempInt(raw[i]);
+			}
+		}
+		else
+		{
+			for (uint32_t i = 0; i < count; i++)
+			{
+				sumFloat += sensor.calcTemp(raw[i]);
+			}
+		}
+		results += count;
+		elapsed = now() - start;
+	} while (elapsed < BENCH_MIN_TIME);
+	s_sinkFloat = sumFloat;
+	s_sinkInt = sumInt;
+	return (double)elapsed / results;
+}
+
+/**
+ * compares all paths of one coefficient set with the reference and times them
+ *
+ * @return 	0 on success, -1 if the driver could not be initialized or a path exceeds the limits
+ */
+template <class Bench, class Ref>
+static int runSet(const CoefSet_t &set, uint8_t simChip, uint8_t coefAddress, uint8_t coefLength, uint32_t step,
+				  const Limits_t &limits)
+{
+	DpsI2cSim sim(simChip);
+	sim.loadBlock(coefAddress, set.regs, coefLength);
+	DpsLinuxI2c bus(sim);
+	Bench sensor;
+	sensor.begin(bus);
+	if (sensor.initFailed())
+	{
+		fprintf(stderr, "dpsbench: %s: initialization failed\n", set.name);
+		return -1;
+	}
+	Ref ref(set.regs);
+
+	//pressure raw values over the 24 bit range, including both ends
+	uint32_t count = (((uint32_t)1 << 24) - 1U) / step + 1U;
+	int32_t *raw = (int32_t *)malloc((count + 1U) * sizeof(int32_t));
+	if (raw == NULL)
+	{
+		return -1;
+	}
+	for (uint32_t i = 0; i < count; i++)
+	{
+		raw[i] = -8388608 + (int32_t)(i * step);
+	}
+	if (raw[count - 1U] != 8388607)
+	{
+		raw[count++] = 8388607;
+	}
+	const uint8_t numTemps = sizeof(benchTemps) / sizeof(benchTemps[0]);
+	int32_t tempRaw[DPS__NUM_OF_SCAL_FACTS * sizeof(benchTemps)];
+	for (uint8_t osr = 0; osr < DPS__NUM_OF_SCAL_FACTS; osr++)
+	{
+		for (uint8_t j = 0; j < numTemps; j++)
+		{
+			tempRaw[osr * numTemps + j] = ref.rawTemp(benchTemps[j], osr);
+		}
+	}
+
+	//temperatures from -40 to 85 °C for timing
+	int32_t timingTemps[BENCH_TIMING_TEMPS];
+	int32_t coldest = tempRaw[DPS__OVERSAMPLING_RATE_128 * numTemps];
+	int32_t hottest = tempRaw[DPS__OVERSAMPLING_RATE_128 * numTemps + numTemps - 1U];
+	for (uint32_t i = 0; i < BENCH_TIMING_TEMPS; i++)
+	{
+		timingTemps[i] = coldest + (int32_t)((int64_t)(hottest - coldest) * i / (BENCH_TIMING_TEMPS - 1U));
+	}
+
+	int ret = 0;
+	for (uint8_t impl = 0; impl < IMPL_COUNT; impl++)
+	{
+		Error_t error;
+		memset(&error, 0, sizeof(error));
+		for (uint8_t osr = 0; osr < DPS__NUM_OF_SCAL_FACTS; osr++)
+		{
+			sensor.setOsr(osr);
+			for (uint8_t j = 0; j < numTemps; j++)
+			{
+				int32_t rawT = tempRaw[osr * numTemps + j];
+				double e = fabs(compensateTemp(sensor, impl, rawT) - ref.temp(rawT, osr));
+				error.maxTemp = e > error.maxTemp ? e : error.maxTemp;
+				for (uint32_t i = 0; i < count; i++)
+				{
+					double expected = ref.pressure(raw[i], osr);
+					//beyond what the integer path can return in 0.01 Pa; skipped for all paths, so they stay comparable
+					if (fabs(expected) > BENCH_INT_PRS_LIMIT)
+					{
+						continue;
+					}
+					e = fabs(compensatePressure(sensor, impl, raw[i]) - expected);
+					error.max = e > error.max ? e : error.max;
+					if (expected >= BENCH_RANGE_MIN && expected <= BENCH_RANGE_MAX && e > error.maxInRange)
+					{
+						error.maxInRange = e;
+					}
+					error.sumSquares += e * e;
+					error.count++;
+				}
+			}
+		}
+
+		//timed at the highest oversampling rate, pressures at 25 °C
+		sensor.setOsr(DPS__OVERSAMPLING_RATE_128);
+		double nsTemp = timeTemp(sensor, impl, timingTemps, BENCH_TIMING_TEMPS);
+		compensateTemp(sensor, impl, tempRaw[DPS__OVERSAMPLING_RATE_128 * numTemps + 1U]);
+		double nsPrs = timePressure(sensor, impl, raw, count);
+
+		printf("%-16s %-15s %12.4f %12.4f %10.4f %10.5f %8.2f %8.2f\n", set.name, implNames[impl], error.max,
+			   error.maxInRange, sqrt(error.sumSquares / error.count), error.maxTemp, nsPrs, nsTemp);
+		//also catches NaN
+		if (!(error.maxInRange <= limits.maxInRange && error.max <= limits.max))
+		{
+			fprintf(stderr, "dpsbench: %s: %s exceeds the error limits\n", set.name, implNames[impl]);
+			ret = -1;
+		}
+	}
+	free(raw);
+	return ret;
+}
+
+static int hexValue(char c)
+{
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+	c = tolower(c);
+	return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+}
+
+/**
+ * @return 	number of bytes decoded, -1 if the string is not hex
+ */
+static int parseHex(const char *hex, uint8_t *buffer, uint8_t maxLength)
+{
+	int length = 0;
+	while (*hex != '\0' && !isspace((unsigned char)*hex))
+	{
+		int high = hexValue(hex[0]);
+		int low = hex[1] != '\0' ? hexValue(hex[1]) : -1;
+		if (high < 0 || low < 0 || length >= maxLength)
+		{
+			return -1;
+		}
+		buffer[length++] = (uint8_t)(high << 4 | low);
+		hex += 2;
+	}
+	return length;
+}
+
+static uint8_t coefLength(uint16_t chip)
+{
+	return chip == 310 ? 18U : 26U;
+}
+
+static int addSet(CoefSet_t *sets, uint8_t &numSets, uint16_t chip, const char *name, const char *hex)
+{
+	if (numSets >= BENCH_MAX_SETS || (chip != 310 && chip != 422))
+	{
+		return -1;
+	}
+	CoefSet_t &set = sets[numSets];
+	set.chip = chip;
+	snprintf(set.name, sizeof(set.name), "%s", name);
+	if (parseHex(hex, set.regs, BENCH_MAX_REGS) != coefLength(chip))
+	{
+		return -1;
+	}
+	numSets++;
+	return 0;
+}
+
+static int loadCorpus(const char *path, CoefSet_t *sets, uint8_t &numSets)
+{
+	FILE *file = fopen(path, "r");
+	if (file == NULL)
+	{
+		fprintf(stderr, "dpsbench: cannot open %s\n", path);
+		return -1;
+	}
+	char line[256];
+	unsigned lineNumber = 0;
+	int ret = 0;
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		lineNumber++;
+		char *comment = strchr(line, '#');
+		if (comment != NULL)
+		{
+			*comment = '\0';
+		}
+		unsigned chip;
+		char hex[128];
+		if (sscanf(line, "%u %127s", &chip, hex) != 2)
+		{
+			continue;
+		}
+		char name[24];
+		snprintf(name, sizeof(name), "%u:%u", chip, lineNumber);
+		if (addSet(sets, numSets, (uint16_t)chip, name, hex) < 0)
+		{
+			fprintf(stderr, "dpsbench: %s:%u: invalid coefficient set\n", path, lineNumber);
+			ret = -1;
+			break;
+		}
+	}
+	fclose(file);
+	return ret;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: dpsbench [-f <corpus file>] [-n] [-s <raw step>] [-r <max error in range>] [-m <max error>]\n");
+}
+
+int main(int argc, char *argv[])
+{
+	static CoefSet_t sets[BENCH_MAX_SETS];
+	uint8_t numSets = 0U;
+	const char *corpus = NULL;
+	int builtIn = 1;
+	uint32_t step = 61U;
+	Limits_t limits = {BENCH_MAX_ERROR_RANGE, BENCH_MAX_ERROR};
+
+	int opt;
+	while ((opt = getopt(argc, argv, "f:ns:r:m:h")) != -1)
+	{
+		switch (opt)
+		{
+		case 'f':
+			corpus = optarg;
+			break;
+		case 'n':
+			builtIn = 0;
+			break;
+		case 's':
+			step = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			limits.maxInRange = strtod(optarg, NULL);
+			break;
+		case 'm':
+			limits.max = strtod(optarg, NULL);
+			break;
+		default:
+			usage();
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (step == 0U)
+	{
+		usage();
+		return 2;
+	}
+	if (builtIn)
+	{
+		addSet(sets, numSets, 310, "310:typical-a", "0d1efd13880f3cb0f4480514d8f000c8faec");
+		addSet(sets, numSets, 310, "310:typical-b", "0ccefb13a55f2a0ff811053cd6ae00bbfa7c");
+		addSet(sets, numSets, 422, "422:typical-a", "05fa0a0000001117009c40ffa24000c87448012c00fa7ff38028");
+		addSet(sets, numSets, 422, "422:typical-b", "f40deb0000000cb200f618ff6a00015e6ffc01a4017c7fe98041");
+	}
+	if (corpus != NULL && loadCorpus(corpus, sets, numSets) < 0)
+	{
+		return 1;
+	}
+
+	printf("errors against double precision: pressure in Pa over the 24 bit raw range (step %u, up to %.0f Pa)\n"
+		   "and between %.0f and %.0f Pa, temperature in °C; time per result in ns\n\n",
+		   step, BENCH_INT_PRS_LIMIT, BENCH_RANGE_MIN, BENCH_RANGE_MAX);
+	printf("%-16s %-15s %12s %12s %10s %10s %8s %8s\n", "set", "path", "max", "max range", "rms", "max temp", "ns/prs", "ns/temp");
+	int ret = 0;
+	for (uint8_t i = 0; i < numSets; i++)
+	{
+		if (sets[i].chip == 310)
+		{
+			ret |= runSet<Bench310, Ref310>(sets[i], DpsSimChip::SIM_DPS310, 0x10, coefLength(310), step, limits);
+		}
+		else
+		{
+			ret |= runSet<Bench422, Ref422>(sets[i], DpsSimChip::SIM_DPS422, 0x20, coefLength(422), step, limits);
+		}
+	}
+	return ret ? 1 : 0;
+}
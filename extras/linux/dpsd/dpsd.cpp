@@ -0,0 +1,260 @@
+/**
+ * @brief dpsd - acquisition daemon for Linux hosts
+ *
+ * Owns the bus and one DPS310 or DPS422 in continuous mode and publishes all results
+ * into a shared memory ring (see DpsShmRing.h), so any number of processes can use
+ * the same stream without talking to the sensor.
+ *
+ * usage: dpsd -b i2c:<bus>[:<address>] | spi:<bus>.<chipselect> [-c 310|422] [-r <prs rate>] [-t <temp rate>]
+ *             [-n <shm name>] [-s <slots>]
+ *
+ * The measurement configuration for the requested rates is chosen by dps::planMeasurement.
+ *
+ * @file dpsd.cpp
+ * @author Infineon Technologies
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Dps310.h"
+#include "Dps422.h"
+#include "DpsPlanner.h"
+#include "DpsLinuxI2c.h"
+#include "DpsLinuxSpi.h"
+#include "DpsShmRing.h"
+
+static volatile sig_atomic_t s_stop = 0;
+
+static void onSignal(int signal)
+{
+	(void)signal;
+	s_stop = 1;
+}
+
+/**
+ * @return 	measure rate in results per second (1 - 128), 0 if text is not one
+ */
+static uint8_t parseRate(const char *text)
+{
+	char *end;
+	long rate = strtol(text, &end, 0);
+	return (*text != '\0' && *end == '\0' && rate >= 1 && rate <= 128) ? (uint8_t)rate : 0U;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: dpsd -b i2c:<bus>[:<address>] | spi:<bus>.<chipselect> [-c 310|422] [-r <prs rate>] [-t <temp rate>]\n"
+					"            [-n <shm name>] [-s <slots>]\n");
+}
+
+/**
+ * publishes the results of one drain
+ * The FIFO does not store timestamps: the last result of each type is assumed to be
+ * the most recent one, the others are spaced by the measure rate.
+ */
+static void publish(DpsShmWriter &ring, uint8_t type, const float *values, uint8_t count, uint32_t rate, uint64_t timestamp)
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		DpsSample_t sample;
+		sample.timestamp = timestamp - (uint64_t)(count - 1U - i) * 1000000000ULL / rate;
+		sample.value = values[i];
+		sample.type = type;
+		sample.sensor = 0U;
+		sample.reserved = 0U;
+		ring.publish(sample);
+	}
+}
+
+/**
+ * runs the acquisition until SIGINT or SIGTERM
+ * The sensor type is a template parameter, since getContResults is not virtual.
+ */
+template <class Sensor>
+static int acquire(Sensor &sensor, DpsTransport &transport, const char *busSpec, const DpsPlan_t &plan,
+				   const char *name, uint32_t slots)
+{
+	//a failed initialization is reported by startMeasureBothCont
+	sensor.begin(transport);
+
+	int ret = sensor.startMeasureBothCont(plan.tempMr, plan.tempOsr, plan.prsMr, plan.prsOsr);
+	if (ret != DPS__SUCCEEDED)
+	{
+		fprintf(stderr, "dpsd: cannot start the sensor on %s (%d)\n", busSpec, ret);
+		return 1;
+	}
+	uint32_t tempRate = 1U << plan.tempMr;
+	uint32_t prsRate = 1U << plan.prsMr;
+
+	//ring
+	DpsShmWriter ring;
+	ret = ring.create(name, slots);
+	if (ret < 0)
+	{
+		fprintf(stderr, "dpsd: cannot create %s: %s\n", name, strerror(-ret));
+		sensor.standby();
+		return 1;
+	}
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = onSignal;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	//drain when the FIFO is about half full
+	uint32_t interval = dps::drainInterval(plan);
+	fprintf(stderr, "dpsd: %s -> %s, %u Pa/s, %u °C/s, drain every %u ms\n", busSpec, name, prsRate, tempRate, interval);
+
+	float tempBuffer[DPS__FIFO_SIZE];
+	float prsBuffer[DPS__FIFO_SIZE];
+	while (!s_stop)
+	{
+		struct timespec sleep = {(time_t)(interval / 1000U), (long)(interval % 1000U) * 1000000L};
+		nanosleep(&sleep, NULL);
+
+		uint8_t tempCount = DPS__FIFO_SIZE;
+		uint8_t prsCount = DPS__FIFO_SIZE;
+		ret = sensor.getContResults(tempBuffer, tempCount, prsBuffer, prsCount);
+		uint64_t timestamp = dpsSampleTime();
+		if (ret != DPS__SUCCEEDED)
+		{
+			fprintf(stderr, "dpsd: reading results failed (%d)\n", ret);
+			continue;
+		}
+		publish(ring, dps::SAMPLE_TEMP, tempBuffer, tempCount, tempRate, timestamp);
+		publish(ring, dps::SAMPLE_PRS, prsBuffer, prsCount, prsRate, timestamp);
+		if (tempCount + prsCount > 0U)
+		{
+			ring.notify();
+		}
+	}
+
+	sensor.standby();
+	ring.close();
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *busSpec = NULL;
+	const char *name = DPS_SHM_DEFAULT_NAME;
+	int chip = 310;
+	uint32_t slots = DPS_SHM_DEFAULT_CAPACITY;
+	DpsPlanRequest_t request;
+	memset(&request, 0, sizeof(request));
+	request.prsRate = 8U;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "b:c:r:t:n:s:h")) != -1)
+	{
+		switch (opt)
+		{
+		case 'b':
+			busSpec = optarg;
+			break;
+		case 'c':
+			chip = atoi(optarg);
+			break;
+		case 'r':
+			request.prsRate = parseRate(optarg);
+			if (request.prsRate == 0U)
+			{
+				usage();
+				return 2;
+			}
+			break;
+		case 't':
+			request.tempRate = parseRate(optarg);
+			if (request.tempRate == 0U)
+			{
+				usage();
+				return 2;
+			}
+			break;
+		case 'n':
+			name = optarg;
+			break;
+		case 's':
+			slots = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage();
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (busSpec == NULL || (chip != 310 && chip != 422))
+	{
+		usage();
+		return 2;
+	}
+	if (request.tempRate == 0U)
+	{
+		request.tempRate = request.prsRate;
+	}
+
+	DpsPlan_t plan;
+	if (dps::planMeasurement(request, plan) != DPS__SUCCEEDED)
+	{
+		fprintf(stderr, "dpsd: no configuration for %u pressure and %u temperature results per second\n",
+				request.prsRate, request.tempRate);
+		return 2;
+	}
+
+	//bus
+	DpsI2cDev i2cDev;
+	DpsSpiDev spiDev;
+	DpsTransport *transport = NULL;
+	int bus;
+	int second;
+	int ret = sscanf(busSpec, "i2c:%d:%i", &bus, &second);
+	if (ret >= 1)
+	{
+		if (ret < 2)
+		{
+			second = DPS__STD_SLAVE_ADDRESS;
+		}
+		ret = i2cDev.open(bus);
+		if (ret >= 0)
+		{
+			transport = new DpsLinuxI2c(i2cDev, (uint8_t)second);
+		}
+	}
+	else if (sscanf(busSpec, "spi:%d.%d", &bus, &second) == 2)
+	{
+		ret = spiDev.open(bus, second);
+		if (ret >= 0)
+		{
+			transport = new DpsLinuxSpi(spiDev);
+		}
+	}
+	else
+	{
+		usage();
+		return 2;
+	}
+	if (ret < 0)
+	{
+		fprintf(stderr, "dpsd: cannot open %s: %s\n", busSpec, strerror(-ret));
+		return 1;
+	}
+
+	if (chip == 422)
+	{
+		Dps422 sensor;
+		ret = acquire(sensor, *transport, busSpec, plan, name, slots);
+	}
+	else
+	{
+		Dps310 sensor;
+		ret = acquire(sensor, *transport, busSpec, plan, name, slots);
+	}
+	delete transport;
+	return ret;
+}
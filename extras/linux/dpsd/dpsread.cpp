@@ -0,0 +1,73 @@
+/**
+ * @brief dpsread - prints the samples published by dpsd
+ *
+ * usage: dpsread [-n <shm name>] [-c <count>]
+ *
+ * @file dpsread.cpp
+ * @author Infineon Technologies
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "DpsShmRing.h"
+
+int main(int argc, char *argv[])
+{
+	const char *name = DPS_SHM_DEFAULT_NAME;
+	uint64_t count = 0U;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:c:h")) != -1)
+	{
+		switch (opt)
+		{
+		case 'n':
+			name = optarg;
+			break;
+		case 'c':
+			count = strtoull(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "usage: dpsread [-n <shm name>] [-c <count>]\n");
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+
+	DpsShmReader ring;
+	int ret = ring.open(name);
+	if (ret < 0)
+	{
+		fprintf(stderr, "dpsread: cannot open %s: %s\n", name, strerror(-ret));
+		return 1;
+	}
+
+	uint64_t done = 0U;
+	while (count == 0U || done < count)
+	{
+		if (!ring.wait(1000U))
+		{
+			if (!ring.isWriterAlive())
+			{
+				break;
+			}
+			continue;
+		}
+		DpsSample_t sample;
+		while (ring.read(sample) && (count == 0U || done < count))
+		{
+			printf("%" PRIu64 ".%09" PRIu64 " %u %s %f\n", (uint64_t)(sample.timestamp / 1000000000U), (uint64_t)(sample.timestamp % 1000000000U),
+				   sample.sensor, sample.type == dps::SAMPLE_PRS ? "prs" : "temp", sample.value);
+			done++;
+		}
+		fflush(stdout);
+	}
+	if (ring.getLost() > 0U)
+	{
+		fprintf(stderr, "dpsread: %" PRIu64 " samples lost\n", ring.getLost());
+	}
+	return 0;
+}
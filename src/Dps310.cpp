@@ -8,58 +8,69 @@ int16_t Dps310::getContResults(float *tempBuffer,
 							   float *prsBuffer,
 							   uint8_t &prsCount)
 {
-	return DpsClass::getContResults(tempBuffer, tempCount, prsBuffer, prsCount, registers[FIFO_EMPTY]);
+	return DpsClass::getContResults<FIFO_EMPTY, FIFO_FULL>(tempBuffer, tempCount, prsBuffer, prsCount);
+}
+
+int16_t Dps310::getContResults(int32_t *tempBuffer,
+							   uint8_t &tempCount,
+							   int32_t *prsBuffer,
+							   uint8_t &prsCount)
+{
+	return DpsClass::getContResults<FIFO_EMPTY, FIFO_FULL>(tempBuffer, tempCount, prsBuffer, prsCount);
+}
+
+int16_t Dps310::getContRawResults(int32_t *raw, uint8_t &count)
+{
+	return DpsClass::getContRawResults<FIFO_EMPTY, FIFO_FULL>(raw, count);
 }
 
-#ifndef DPS_DISABLESPI
 int16_t Dps310::setInterruptSources(uint8_t intr_source, uint8_t polarity)
 {
+	DPS_API_SCOPE(API_SET_INTERRUPT_SOURCES);
+#ifndef DPS_DISABLESPI
 	//Interrupts are not supported with 4 Wire SPI
 	if (!m_SpiI2c & !m_threeWire)
 	{
 		return DPS__FAIL_UNKNOWN;
 	}
-	return writeByteBitfield(intr_source, registers[INT_SEL]) || writeByteBitfield(polarity, registers[INT_HL]);
-}
 #endif
+	//both fields are in CFG_REG and written with one access
+	return writeByteBitfield<INT_HL, INT_SEL>(polarity, intr_source);
+}
+
+int16_t Dps310::enableReadyInterrupts(uint8_t polarity)
+{
+	return setInterruptSources(DPS310_BOTH_INTR, polarity);
+}
 
 void Dps310::init(void)
 {
-	int16_t prodId = readByteBitfield(registers[PROD_ID]);
-	if (prodId < 0)
+	//configuration writes are sent together with the following reads
+	BusBatch batch(*this);
+	//IDs, coefficients and temperature sensor recommendation are read in one burst
+	uint8_t snapshot[DPS310__INIT_BLOCK_LENGTH];
+	if (readBlock(initBlock, snapshot) != initBlock.length)
 	{
 		//Connected device is not a Dps310
 		m_initFail = 1U;
 		return;
 	}
-	m_productID = prodId;
-
-	int16_t revId = readByteBitfield(registers[REV_ID]);
-	if (revId < 0)
-	{
-		m_initFail = 1U;
-		return;
-	}
-	m_revisionID = revId;
+	m_productID = PROD_ID::decode(snapshot[PROD_ID::regAddress - initBlock.regAddress]);
+	m_revisionID = REV_ID::decode(snapshot[REV_ID::regAddress - initBlock.regAddress]);
 
 	//find out which temperature sensor is calibrated with coefficients...
-	int16_t sensor = readByteBitfield(registers[TEMP_SENSORREC]);
-	if (sensor < 0)
-	{
-		m_initFail = 1U;
-		return;
-	}
+	uint8_t sensor = TEMP_SENSORREC::decode(snapshot[TEMP_SENSORREC::regAddress - initBlock.regAddress]);
 
 	//...and use this sensor for temperature measurement
 	m_tempSensor = sensor;
-	if (writeByteBitfield((uint8_t)sensor, registers[TEMP_SENSOR]) < 0)
+	if (writeByteBitfield<TEMP_SENSOR>(sensor) < 0)
 	{
 		m_initFail = 1U;
 		return;
 	}
 
-	//read coefficients
-	if (readcoeffs() < 0)
+	//decode coefficients
+	if (readcoeffs(snapshot) < 0)
 	{
 		m_initFail = 1U;
 		return;
@@ -86,12 +97,10 @@ void Dps310::init(void)
 	correctTemp();
 }
 
-int16_t Dps310::readcoeffs(void)
+int16_t Dps310::readcoeffs(const uint8_t *snapshot)
 {
-	// TODO: remove magic number
-	uint8_t buffer[18];
-	//read COEF registers to buffer
-	int16_t ret = readBlock(coeffBlock, buffer);
+	//COEF registers within the init block
+	const uint8_t *buffer = snapshot + (coeffBlock.regAddress - initBlock.regAddress);
 
 	//compose coefficients from buffer content
 	m_c0Half = ((uint32_t)buffer[0] << 4) | (((uint32_t)buffer[1] >> 4) & 0x0F);
@@ -118,73 +127,106 @@ int16_t Dps310::readcoeffs(void)
 	getTwosComplement(&m_c21, 16);
 	m_c30 = ((uint32_t)buffer[16] << 8) | (uint32_t)buffer[17];
 	getTwosComplement(&m_c30, 16);
+
+	foldTrim();
 	return DPS__SUCCEEDED;
 }
 
+void Dps310::foldTrim(void)
+{
+	//T' = c0 / 2 + tempOffset + c1 * t
+	m_k.t0 = m_c0Half + m_trim.tempOffset;
+	m_k.t1 = m_c1;
+	//P' = prsOffset + prsGain * P + prsTempCoeff * (T - DPS__TRIM_REF_TEMP),
+	//T is linear in the scaled temperature t, so the temperature term goes to c00 and c01
+	float gain = m_trim.prsGain;
+	float tempCoeff = m_trim.prsTempCoeff;
+	m_k.c00 = gain * m_c00 + m_trim.prsOffset + tempCoeff * (m_c0Half - DPS__TRIM_REF_TEMP);
+	m_k.c10 = gain * m_c10;
+	m_k.c01 = gain * m_c01 + tempCoeff * m_c1;
+	m_k.c11 = gain * m_c11;
+	m_k.c20 = gain * m_c20;
+	m_k.c21 = gain * m_c21;
+	m_k.c30 = gain * m_c30;
+	m_k.c02 = 0.0f;
+	m_k.c12 = 0.0f;
+
+	m_kInt.t0 = m_c0Half * DPS__INT_TEMP_SCALE + dps::roundToInt(m_trim.tempOffset * DPS__INT_TEMP_SCALE);
+	foldTrimInt();
+}
+
 int16_t Dps310::configTemp(uint8_t tempMr, uint8_t tempOsr)
 {
-	int16_t ret = DpsClass::configTemp(tempMr, tempOsr);
+	tempMr &= 0x07;
+	tempOsr &= 0x07;
+	//sensor selection, measure rate and oversampling rate share one register and are written at once
+	if (writeByteBitfield<TEMP_SENSOR, TEMP_MR, TEMP_OSR>(m_tempSensor, tempMr, tempOsr) != DPS__SUCCEEDED)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	m_tempMr = tempMr;
+	m_tempOsr = tempOsr;
 
-	writeByteBitfield(m_tempSensor, registers[TEMP_SENSOR]);
 	//set TEMP SHIFT ENABLE if oversampling rate higher than eight(2^3)
 	if (tempOsr > DPS310__OSR_SE)
 	{
-		ret = writeByteBitfield(1U, registers[TEMP_SE]);
+		return writeByteBitfield<TEMP_SE>(1U);
 	}
 	else
 	{
-		ret = writeByteBitfield(0U, registers[TEMP_SE]);
+		return writeByteBitfield<TEMP_SE>(0U);
 	}
-	return ret;
 }
 
 int16_t Dps310::configPressure(uint8_t prsMr, uint8_t prsOsr)
 {
 	int16_t ret = DpsClass::configPressure(prsMr, prsOsr);
+	if (ret != DPS__SUCCEEDED)
+	{
+		return ret;
+	}
 	//set PM SHIFT ENABLE if oversampling rate higher than eight(2^3)
 	if (prsOsr > DPS310__OSR_SE)
 	{
-		ret = writeByteBitfield(1U, registers[PRS_SE]);
+		ret = writeByteBitfield<PRS_SE>(1U);
 	}
 	else
 	{
-		ret = writeByteBitfield(0U, registers[PRS_SE]);
+		ret = writeByteBitfield<PRS_SE>(0U);
 	}
 	return ret;
 }
 
-float Dps310::calcTemp(int32_t raw)
+int16_t Dps310::configBothCont(uint8_t tempCfg, uint8_t prsCfg, uint8_t tempShift, uint8_t prsShift)
 {
-	float temp = raw;
-
-	//scale temperature according to scaling table and oversampling
-	temp /= scaling_facts[m_tempOsr];
-
-	//update last measured temperature
-	//it will be used for pressure compensation
-	m_lastTempScal = temp;
-
-	//Calculate compensated temperature
-	temp = m_c0Half + m_c1 * temp;
-
-	return temp;
+	//all bits of TEMP_CFG and PRS_CFG are known, so they are written without reading first
+	if (writeByte(TEMP_SENSOR::regAddress, TEMP_SENSOR::encode(m_tempSensor) | tempCfg) ||
+		writeByte(PRS_MR::regAddress, prsCfg))
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	//shift enable bits and FIFO enable share one register
+	return writeByteBitfield<TEMP_SE, PRS_SE, FIFO_EN>(tempShift, prsShift, 1U);
 }
 
-float Dps310::calcPressure(int32_t raw)
+int16_t Dps310::flushFIFO()
 {
-	float prs = raw;
-
-	//scale pressure according to scaling table and oversampling
-	prs /= scaling_facts[m_prsOsr];
-
-	//Calculate compensated pressure
-	prs = m_c00 + prs * (m_c10 + prs * (m_c20 + prs * m_c30)) + m_lastTempScal * (m_c01 + prs * (m_c11 + prs * m_c21));
+	//soft reset shares the register, writing 0 to it has no effect
+	return writeByte(FIFO_FL::regAddress, FIFO_FL::encode(1U));
+}
 
-	//return pressure
-	return prs;
+int16_t Dps310::softReset(void)
+{
+	//FIFO flush shares the register, writing 0 to it has no effect
+	return writeByte(SOFT_RESET::regAddress, SOFT_RESET::encode(DPS__SOFT_RESET_CMD));
 }
 
-int16_t Dps310::flushFIFO()
+int16_t Dps310::getSensorReady(void)
 {
-	return writeByteBitfield(1U, registers[FIFO_FL]);
+	int16_t ret = readByte(SENSOR_RDY::regAddress);
+	if (ret < 0)
+	{
+		return ret;
+	}
+	return SENSOR_RDY::decode(ret) && COEF_RDY::decode(ret);
 }
@@ -3,11 +3,46 @@
 
 #include "DpsClass.h"
 #include "util/dps310_config.h"
+#include "util/DpsFixedPoint.h"
 
 class Dps310 : public DpsClass
 {
 public:
   int16_t getContResults(float *tempBuffer, uint8_t &tempCount, float *prsBuffer, uint8_t &prsCount);
+  int16_t getContResults(int32_t *tempBuffer, uint8_t &tempCount, int32_t *prsBuffer, uint8_t &prsCount);
+
+  /**
+   * @brief Gets the raw results from continuous measurements in FIFO order, see DpsClass::getContRawResults
+   * 
+   * @param raw buffer for the raw values
+   * @param count size of the buffer; number of values written to it when the function returns
+   * @return status code
+   */
+  int16_t getContRawResults(int32_t *raw, uint8_t &count);
+
+  /**
+   * @brief Hands each result of a continuous measurement to handler while the FIFO is drained, see DpsClass::getContSamples
+   * 
+   * @param handler function, lambda or object with operator(), called as handler(const DpsResult<float> &)
+   * @return status code
+   */
+  template <class Handler>
+  int16_t getContSamples(Handler &handler)
+  {
+    //virtual compensation, like getContResults
+    DpsClass &comp = *this;
+    return DpsClass::getContSamples<dps310::FIFO_EMPTY, dps310::FIFO_FULL, float>(comp, handler);
+  }
+
+  /**
+   * @brief Like getContSamples, with results in 0.001 °C and 0.01 Pa, called as handler(const DpsResult<int32_t> &)
+   */
+  template <class Handler>
+  int16_t getContSamplesInt(Handler &handler)
+  {
+    IntCompensation comp(*this);
+    return DpsClass::getContSamples<dps310::FIFO_EMPTY, dps310::FIFO_FULL, int32_t>(comp, handler);
+  }
 
   /**
    * @brief Set the source of interrupt (FIFO full, measurement values ready)
@@ -18,6 +53,15 @@ public:
    */
   int16_t setInterruptSources(uint8_t intr_source, uint8_t polarity = 1);
 
+  /**
+   * @brief Signals finished temperature and pressure measurements on the interrupt pin,
+   * so single measurements can be completed with getReadyResult instead of waiting for the worst case
+   *
+   * @param polarity 1 for active high, 0 for active low
+   * @return status code
+   */
+  int16_t enableReadyInterrupts(uint8_t polarity = 1);
+
 protected:
   uint8_t m_tempSensor;
 
@@ -30,10 +74,136 @@ protected:
   void init(void);
   int16_t configTemp(uint8_t temp_mr, uint8_t temp_osr);
   int16_t configPressure(uint8_t prs_mr, uint8_t prs_osr);
-  int16_t readcoeffs(void);
+  int16_t configBothCont(uint8_t tempCfg, uint8_t prsCfg, uint8_t tempShift, uint8_t prsShift);
+  int16_t readcoeffs(const uint8_t *snapshot);
+  void foldTrim(void);
+
+  /**
+   * calculates m_prsPoly from the last temperature and the pressure oversampling rate
+   */
+  void foldTemp(void);
   int16_t flushFIFO();
+  int16_t softReset(void);
+  int16_t getSensorReady(void);
   float calcTemp(int32_t raw);
   float calcPressure(int32_t raw);
+  int32_t calcTempInt(int32_t raw);
+  int32_t calcPressureInt(int32_t raw);
+};
+
+// compensation is defined inline, so that DpsSensor<Dps310Traits> can inline it into the FIFO drain loop
+
+inline float Dps310::calcTemp(int32_t raw)
+{
+  float temp = raw;
+
+  //scale temperature according to scaling table and oversampling
+  temp /= scaling_facts[m_tempOsr];
+
+  //update last measured temperature
+  //it will be used for pressure compensation
+  m_lastTempScal = temp;
+  m_lastTempRaw = raw;
+  m_lastTempOsr = m_tempOsr;
+  m_lastTempScalValid = DPS__TEMP_SCAL_FLOAT;
+  //temperature changes much slower than pressure, so its terms are folded into the pressure polynomial once
+  foldTemp();
+
+  //Calculate compensated temperature
+  temp = m_k.t0 + m_k.t1 * temp;
+
+  return temp;
+}
+
+inline void Dps310::foldTemp(void)
+{
+  //the last temperature has been measured by the integer compensation
+  if (!(m_lastTempScalValid & DPS__TEMP_SCAL_FLOAT))
+  {
+    m_lastTempScal = (float)m_lastTempRaw / scaling_facts[m_lastTempOsr];
+    m_lastTempScalValid |= DPS__TEMP_SCAL_FLOAT;
+  }
+  float t = m_lastTempScal;
+  float s = 1.0f / scaling_facts[m_prsOsr];
+
+  //c00 + c01 * t + p * (c10 + c11 * t + p * (c20 + c21 * t + p * c30)) with p = raw * s
+  m_prsPoly[0] = m_k.c00 + t * m_k.c01;
+  m_prsPoly[1] = (m_k.c10 + t * m_k.c11) * s;
+  m_prsPoly[2] = (m_k.c20 + t * m_k.c21) * s * s;
+  m_prsPoly[3] = m_k.c30 * s * s * s;
+  m_prsPolyOsr = m_prsOsr;
+  m_lastTempScalValid |= DPS__TEMP_SCAL_POLY;
+}
+
+inline float Dps310::calcPressure(int32_t raw)
+{
+  //temperature measured by the integer compensation, new oversampling rate or new trim
+  if (!(m_lastTempScalValid & DPS__TEMP_SCAL_POLY) || m_prsPolyOsr != m_prsOsr)
+  {
+    foldTemp();
+  }
+  float prs = raw;
+
+  //Calculate compensated pressure
+  return m_prsPoly[0] + prs * (m_prsPoly[1] + prs * (m_prsPoly[2] + prs * m_prsPoly[3]));
+}
+
+inline int32_t Dps310::calcTempInt(int32_t raw)
+{
+  int32_t scaling = scaling_facts[m_tempOsr];
+
+  //update last measured temperature as Q24 number
+  //it will be used for pressure compensation
+  m_lastTempScalQ24 = (int32_t)dps::divRound(dps::toQ24(raw), scaling);
+  m_lastTempRaw = raw;
+  m_lastTempOsr = m_tempOsr;
+  m_lastTempScalValid = DPS__TEMP_SCAL_Q24;
+
+  //c0 / 2 + c1 * raw / scaling in 0.001 °C
+  return m_kInt.t0 + (int32_t)dps::divRound((int64_t)m_c1 * raw * DPS__INT_TEMP_SCALE, scaling);
+}
+
+inline int32_t Dps310::calcPressureInt(int32_t raw)
+{
+  int32_t scaling = scaling_facts[m_prsOsr];
+  //scaled pressure as Q22 number
+  int64_t p = dps::divRound(dps::toQ22(raw), scaling);
+
+  //the last temperature has been measured by the float compensation
+  if (!(m_lastTempScalValid & DPS__TEMP_SCAL_Q24))
+  {
+    m_lastTempScalQ24 = (int32_t)dps::divRound(dps::toQ24(m_lastTempRaw), scaling_facts[m_lastTempOsr]);
+    m_lastTempScalValid |= DPS__TEMP_SCAL_Q24;
+  }
+
+  //scaled temperature as Q22 number
+  int64_t t = dps::divRound(m_lastTempScalQ24, 4);
+
+  //sum in Pa as Q16 number, same Horner scheme as calcPressure
+  //c00 + c10 * p, the linear term exactly from the raw value
+  int64_t prs = m_kInt.c00 + dps::divRound(m_kInt.c10 * raw, scaling);
+  //nonlinear terms as Q8 numbers; DpsFixedPoint.h shows that they stay in 64 bits for all raw values
+  //p^2 * (c20 + p * c30)
+  int64_t x = m_kInt.c20 + dps::mulQ22(m_kInt.c30, p);
+  prs += dps::mulQ22ToQ16(dps::mulQ22(x, p), p);
+  //t * (c01 + p * (c11 + p * c21))
+  x = m_kInt.c11 + dps::mulQ22(m_kInt.c21, p);
+  x = m_kInt.c01 + dps::mulQ22(x, p);
+  prs += dps::mulQ22ToQ16(x, t);
+
+  //Q16 Pa to 0.01 Pa
+  return dps::saturateInt32((prs * DPS__INT_PRS_SCALE + (1 << 15)) >> 16);
+}
+
+/**
+ * @brief compile time description of the DPS310 for DpsSensor
+ */
+struct Dps310Traits
+{
+  typedef Dps310 Chip;
+
+  typedef dps310::FIFO_EMPTY FifoEmpty;
+  typedef dps310::FIFO_FULL FifoFull;
 };
 
 #endif
\ No newline at end of file
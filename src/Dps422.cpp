@@ -7,11 +7,41 @@ using namespace dps422;
 
 int16_t Dps422::measureBothOnce(float &prs, float &temp)
 {
-	measureBothOnce(prs, temp, m_prsOsr, m_tempOsr);
+	return measureBothOnce(prs, temp, m_prsOsr, m_tempOsr);
 }
 
 int16_t Dps422::measureBothOnce(float &prs, float &temp, uint8_t prs_osr, uint8_t temp_osr)
 {
+	DPS_API_SCOPE(API_MEASURE_BOTH_ONCE);
+	int16_t ret = startMeasureBothOnce(prs_osr, temp_osr);
+	if (ret != DPS__SUCCEEDED)
+	{
+		return ret;
+	}
+	delay(((calcBusyTime(0U, m_tempOsr) + calcBusyTime(0U, m_prsOsr)) / DPS__BUSYTIME_SCALING));
+	delay(DPS310__BUSYTIME_FAILSAFE);
+	ret = getBothResults(prs, temp);
+	if (ret != DPS__SUCCEEDED)
+	{
+		standby();
+	}
+	return ret;
+}
+
+int16_t Dps422::startMeasureBothOnce(uint8_t prs_osr, uint8_t temp_osr)
+{
+	DPS_API_SCOPE(API_MEASURE_BOTH_ONCE);
+	//abort if initialization failed
+	if (m_initFail)
+	{
+		return DPS__FAIL_INIT_FAILED;
+	}
+	//abort if device is not in idling mode
+	if (m_opMode != IDLE)
+	{
+		return DPS__FAIL_TOOBUSY;
+	}
+	BusBatch batch(*this);
 	if (prs_osr != m_prsOsr)
 	{
 		if (configPressure(0U, prs_osr))
@@ -22,33 +52,90 @@ int16_t Dps422::measureBothOnce(float &prs, float &temp, uint8_t prs_osr, uint8_
 
 	if (temp_osr != m_tempOsr)
 	{
-		if (configPressure(0U, temp_osr))
+		if (configTemp(0U, temp_osr))
 		{
 			return DPS__FAIL_UNKNOWN;
 		}
 	}
 
-	setOpMode(CMD_BOTH);
-	delay(((calcBusyTime(0U, m_tempOsr) + calcBusyTime(0U, m_prsOsr)) / DPS__BUSYTIME_SCALING));
-	// config_registers defined in namespace dps
-	int16_t rdy = readByteBitfield(config_registers[PRS_RDY]) & readByteBitfield(config_registers[TEMP_RDY]);
-	switch (rdy)
+	m_bothStartTime = millis();
+	return setOpMode(CMD_BOTH);
+}
+
+int16_t Dps422::getBothResults(float &prs, float &temp, uint8_t restart)
+{
+	DPS_API_SCOPE(API_GET_SINGLE_RESULT);
+	//abort if initialization failed
+	if (m_initFail)
+	{
+		return DPS__FAIL_INIT_FAILED;
+	}
+	if (m_opMode != CMD_BOTH)
+	{
+		return DPS__FAIL_TOOBUSY;
+	}
+	//results and ready flags in one transfer
+	uint8_t buffer[DPS__READY_BLOCK_LENGTH];
+	if (readBlock(bothResultsBlock, buffer) != bothResultsBlock.length)
 	{
-	case DPS__FAIL_UNKNOWN: //could not read ready flag
 		return DPS__FAIL_UNKNOWN;
-	case 0: //ready flag not set, measurement still in progress
-		standby();
+	}
+	uint8_t measCfg = buffer[DPS422__BOTH_RESULTS_MEAS_CFG];
+	if (!TEMP_RDY::decode(measCfg) || !PRS_RDY::decode(measCfg))
+	{
+		//measurement still in progress
 		return DPS__FAIL_UNFINISHED;
-	case 1: //measurement ready, expected case
-		m_opMode = IDLE;
-		int32_t raw_temp;
-		int32_t raw_psr;
-		if (getRawResult(&raw_temp, registerBlocks[TEMP]) || getRawResult(&raw_psr, registerBlocks[PRS]))
-			return DPS__FAIL_UNKNOWN;
-		prs = calcPressure(raw_psr);
-		temp = calcTemp(raw_temp);
-		return DPS__SUCCEEDED;
 	}
+	m_opMode = IDLE; //opcode was automatically reseted by the sensor
+
+	//the results are latched, so the next measurement can run while these are compensated
+	int16_t ret = DPS__SUCCEEDED;
+	if (restart)
+	{
+		m_bothStartTime = millis();
+		ret = setOpMode(CMD_BOTH);
+	}
+
+	int32_t raw_psr = (uint32_t)buffer[0] << 16 | (uint32_t)buffer[1] << 8 | (uint32_t)buffer[2];
+	int32_t raw_temp = (uint32_t)buffer[3] << 16 | (uint32_t)buffer[4] << 8 | (uint32_t)buffer[5];
+	getTwosComplement(&raw_psr, 24);
+	getTwosComplement(&raw_temp, 24);
+	//temperature first, the pressure compensation uses it
+	temp = calcTemp(raw_temp);
+	prs = calcPressure(raw_psr);
+	return ret;
+}
+
+int16_t Dps422::measureBothPipelined(float &prs, float &temp)
+{
+	DPS_API_SCOPE(API_MEASURE_BOTH_ONCE);
+	int16_t ret;
+	if (m_opMode != CMD_BOTH)
+	{
+		ret = startMeasureBothOnce(m_prsOsr, m_tempOsr);
+		if (ret != DPS__SUCCEEDED)
+		{
+			return ret;
+		}
+	}
+	//only wait for the part of the measurement that has not passed yet
+	unsigned long busyTime = (calcBusyTime(0U, m_tempOsr) + calcBusyTime(0U, m_prsOsr)) / DPS__BUSYTIME_SCALING;
+	unsigned long elapsed = millis() - m_bothStartTime;
+	if (elapsed < busyTime)
+	{
+		delay(busyTime - elapsed);
+	}
+	ret = getBothResults(prs, temp, 1U);
+	if (ret == DPS__FAIL_UNFINISHED)
+	{
+		delay(DPS310__BUSYTIME_FAILSAFE);
+		ret = getBothResults(prs, temp, 1U);
+	}
+	if (ret != DPS__SUCCEEDED)
+	{
+		standby();
+	}
+	return ret;
 }
 
 int16_t Dps422::getContResults(float *tempBuffer,
@@ -56,28 +143,59 @@ int16_t Dps422::getContResults(float *tempBuffer,
 							   float *prsBuffer,
 							   uint8_t &prsCount)
 {
-	return DpsClass::getContResults(tempBuffer, tempCount, prsBuffer, prsCount, registers[FIFO_EMPTY]);
+	return DpsClass::getContResults<FIFO_EMPTY, FIFO_FULL>(tempBuffer, tempCount, prsBuffer, prsCount);
+}
+
+int16_t Dps422::getContResults(int32_t *tempBuffer,
+							   uint8_t &tempCount,
+							   int32_t *prsBuffer,
+							   uint8_t &prsCount)
+{
+	return DpsClass::getContResults<FIFO_EMPTY, FIFO_FULL>(tempBuffer, tempCount, prsBuffer, prsCount);
+}
+
+int16_t Dps422::getContRawResults(int32_t *raw, uint8_t &count)
+{
+	return DpsClass::getContRawResults<FIFO_EMPTY, FIFO_FULL>(raw, count);
 }
 
-#ifndef DPS_DISABLESPI
 int16_t Dps422::setInterruptSources(uint8_t intr_source, uint8_t polarity)
 {
+	DPS_API_SCOPE(API_SET_INTERRUPT_SOURCES);
+#ifndef DPS_DISABLESPI
 	// Intrrupt only supported by I2C or 3-Wire SPI
 	if (!m_SpiI2c & !m_threeWire)
 	{
 		return DPS__FAIL_UNKNOWN;
 	}
+#endif
 
-	return writeByteBitfield(intr_source, registers[INTR_SEL]) || writeByteBitfield(polarity, registers[INTR_POL]);
+	//both fields are in INT_FIFO_CFG and written with one access
+	return writeByteBitfield<INTR_SEL, INTR_POL>(intr_source, polarity);
+}
+
+int16_t Dps422::enableReadyInterrupts(uint8_t polarity)
+{
+	return setInterruptSources(DPS422_BOTH_INTR, polarity);
 }
-#endif
 
 ////////   private  /////////
 void Dps422::init(void)
 {
 	// m_lastTempScal = 0.08716583251; // in case temperature reading disabled, the default raw temperature value correspond the reference temperature of 27 degress.
+	//configuration writes are sent together with the following reads
+	BusBatch batch(*this);
 	standby();
-	if (readcoeffs() < 0 || writeByteBitfield(0x01, registers[MUST_SET]) < 0)
+	//IDs and both coefficient blocks are read in one burst
+	uint8_t snapshot[DPS422__INIT_BLOCK_LENGTH];
+	if (readBlock(initBlock, snapshot) != initBlock.length)
+	{
+		m_initFail = 1U;
+		return;
+	}
+	m_productID = PROD_ID::decode(snapshot[PROD_ID::regAddress - initBlock.regAddress]);
+	m_revisionID = REV_ID::decode(snapshot[REV_ID::regAddress - initBlock.regAddress]);
+	if (readcoeffs(snapshot) < 0 || writeByteBitfield<MUST_SET>(0x01) < 0)
 	{
 		m_initFail = 1U;
 		return;
@@ -91,12 +209,11 @@ void Dps422::init(void)
 	correctTemp();
 }
 
-int16_t Dps422::readcoeffs(void)
+int16_t Dps422::readcoeffs(const uint8_t *snapshot)
 {
-	uint8_t buffer_temp[3];
-	uint8_t buffer_prs[20];
-	readBlock(coeffBlocks[COEF_TEMP], buffer_temp);
-	readBlock(coeffBlocks[COEF_PRS], buffer_prs);
+	//coefficient blocks within the init block
+	const uint8_t *buffer_temp = snapshot + (coeffBlocks[COEF_TEMP].regAddress - initBlock.regAddress);
+	const uint8_t *buffer_prs = snapshot + (coeffBlocks[COEF_PRS].regAddress - initBlock.regAddress);
 
 	// refer to datasheet
 	// 1. read T_Vbe, T_dVbe and T_gain
@@ -124,6 +241,9 @@ int16_t Dps422::readcoeffs(void)
 	// 7. calculate A' and B'
 	a_prime = DPS422_A_0 * (Vbe_cal + DPS422_ALPHA * dVbe_cal) * (1 + k_ptat);
 	b_prime = -273.15 * (1 + k_ptat) - k_ptat * T_calib;
+	// the same in 0.001 °C for the integer compensation, so that it needs no float arithmetic per result
+	m_aPrimeInt = (int32_t)(a_prime * DPS__INT_TEMP_SCALE + 0.5f);
+	m_bPrimeInt = (int32_t)(b_prime * DPS__INT_TEMP_SCALE - 0.5f);
 
 	// c00, c01, c02, c10 : 20 bits
 	// c11, c12: 17 bits
@@ -148,29 +268,81 @@ int16_t Dps422::readcoeffs(void)
 	getTwosComplement(&m_c21, 14);
 	getTwosComplement(&m_c30, 12);
 
+	foldTrim();
 	return DPS__SUCCEEDED;
 }
 
-int16_t Dps422::flushFIFO()
+void Dps422::foldTrim(void)
+{
+	//T' = A' * u + B' + tempOffset
+	m_k.t0 = b_prime + m_trim.tempOffset;
+	m_k.t1 = a_prime;
+	m_kInt.t0 = m_bPrimeInt + dps::roundToInt(m_trim.tempOffset * DPS__INT_TEMP_SCALE);
+
+	//P' = prsOffset + prsGain * P + prsTempCoeff * (T - DPS__TRIM_REF_TEMP)
+	//T is not linear in the temperature term t = 8.5 * Tsc / (1 + 8.8 * Tsc) of the pressure polynomial,
+	//so it is replaced by the parabola in t through the values at -40 °C, DPS__TRIM_REF_TEMP and 85 °C
+	float gain = m_trim.prsGain;
+	float tempCoeff = m_trim.prsTempCoeff;
+	float h0 = DPS__TRIM_REF_TEMP, h1 = 0.0f, h2 = 0.0f;
+	if (tempCoeff != 0.0f)
+	{
+		const float temps[3] = {-40.0f, DPS__TRIM_REF_TEMP, 85.0f};
+		float t[3];
+		for (uint8_t i = 0; i < 3U; i++)
+		{
+			float u = (temps[i] - b_prime) / a_prime;
+			float tsc = u / (1 - DPS422_ALPHA * u);
+			t[i] = (8.5f * tsc) / (1 + 8.8f * tsc);
+		}
+		//Newton form of the parabola, expanded
+		float d01 = (temps[1] - temps[0]) / (t[1] - t[0]);
+		float d12 = (temps[2] - temps[1]) / (t[2] - t[1]);
+		h2 = (d12 - d01) / (t[2] - t[0]);
+		h1 = d01 - h2 * (t[0] + t[1]);
+		h0 = temps[0] - d01 * t[0] + h2 * t[0] * t[1];
+	}
+	m_k.c00 = gain * m_c00 + m_trim.prsOffset + tempCoeff * (h0 - DPS__TRIM_REF_TEMP);
+	m_k.c01 = gain * m_c01 + tempCoeff * h1;
+	m_k.c02 = gain * m_c02 + tempCoeff * h2;
+	m_k.c10 = gain * m_c10;
+	m_k.c11 = gain * m_c11;
+	m_k.c12 = gain * m_c12;
+	m_k.c20 = gain * m_c20;
+	m_k.c21 = gain * m_c21;
+	m_k.c30 = gain * m_c30;
+	foldTrimInt();
+}
+
+int16_t Dps422::configBothCont(uint8_t tempCfg, uint8_t prsCfg, uint8_t /*tempShift*/, uint8_t /*prsShift*/)
 {
-	return writeByteBitfield(1U, registers[FIFO_FL]);
+	//the DPS422 needs no result shift; MUST_SET is the only other bit of TEMP_CFG
+	if (writeByte(MUST_SET::regAddress, MUST_SET::encode(1U) | tempCfg) ||
+		writeByte(PRS_MR::regAddress, prsCfg))
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	return enableFIFO();
 }
 
-float Dps422::calcTemp(int32_t raw)
+int16_t Dps422::flushFIFO()
 {
-	m_lastTempScal = (float)raw / 1048576;
-	float u = m_lastTempScal / (1 + DPS422_ALPHA * m_lastTempScal);
-	return (a_prime * u + b_prime);
+	//soft reset shares the register, writing 0 to it has no effect
+	return writeByte(FIFO_FL::regAddress, FIFO_FL::encode(1U));
 }
 
-float Dps422::calcPressure(int32_t raw_prs)
+int16_t Dps422::softReset(void)
 {
-	float prs = raw_prs;
-	prs /= scaling_facts[m_prsOsr];
+	//FIFO flush shares the register, writing 0 to it has no effect
+	return writeByte(SOFT_RESET::regAddress, SOFT_RESET::encode(DPS__SOFT_RESET_CMD));
+}
 
-	float temp = (8.5 * m_lastTempScal) / (1 + 8.8 * m_lastTempScal);
+int16_t Dps422::getSensorReady(void)
+{
+	return readByteBitfield<INIT_DONE>();
+}
 
-	prs = m_c00 + m_c10 * prs + m_c01 * temp + m_c20 * prs * prs + m_c02 * temp * temp + m_c30 * prs * prs * prs +
-		  m_c11 * temp * prs + m_c12 * prs * temp * temp + m_c21 * prs * prs * temp;
-	return prs;
-}
\ No newline at end of file
+int16_t Dps422::getFIFOFillLevel(void)
+{
+	return readByteBitfield<FIFO_FILL_LEVEL>();
+}
@@ -11,11 +11,46 @@
 #define DPS422_H_INCLUDED
 #include "DpsClass.h"
 #include "util/dps422_config.h"
+#include "util/DpsFixedPoint.h"
 
 class Dps422 : public DpsClass
 {
 public:
   int16_t getContResults(float *tempBuffer, uint8_t &tempCount, float *prsBuffer, uint8_t &prsCount);
+  int16_t getContResults(int32_t *tempBuffer, uint8_t &tempCount, int32_t *prsBuffer, uint8_t &prsCount);
+
+  /**
+   * @brief Gets the raw results from continuous measurements in FIFO order, see DpsClass::getContRawResults
+   * 
+   * @param raw buffer for the raw values
+   * @param count size of the buffer; number of values written to it when the function returns
+   * @return status code
+   */
+  int16_t getContRawResults(int32_t *raw, uint8_t &count);
+
+  /**
+   * @brief Hands each result of a continuous measurement to handler while the FIFO is drained, see DpsClass::getContSamples
+   * 
+   * @param handler function, lambda or object with operator(), called as handler(const DpsResult<float> &)
+   * @return status code
+   */
+  template <class Handler>
+  int16_t getContSamples(Handler &handler)
+  {
+    //virtual compensation, like getContResults
+    DpsClass &comp = *this;
+    return DpsClass::getContSamples<dps422::FIFO_EMPTY, dps422::FIFO_FULL, float>(comp, handler);
+  }
+
+  /**
+   * @brief Like getContSamples, with results in 0.001 °C and 0.01 Pa, called as handler(const DpsResult<int32_t> &)
+   */
+  template <class Handler>
+  int16_t getContSamplesInt(Handler &handler)
+  {
+    IntCompensation comp(*this);
+    return DpsClass::getContSamples<dps422::FIFO_EMPTY, dps422::FIFO_FULL, int32_t>(comp, handler);
+  }
 
   /**
    * @brief Set the source of interrupt (FIFO full, measurement values ready)
@@ -26,6 +61,15 @@ public:
    */
   int16_t setInterruptSources(uint8_t intr_source, uint8_t polarity = 1);
 
+  /**
+   * @brief Signals finished temperature and pressure measurements on the interrupt pin,
+   * so single measurements can be completed with getReadyResult instead of waiting for the worst case
+   *
+   * @param polarity 1 for active high, 0 for active low
+   * @return status code
+   */
+  int16_t enableReadyInterrupts(uint8_t polarity = 1);
+
   /**
    * @brief measures both temperature and pressure values, when op mode is set to CMD_BOTH
    * 
@@ -37,19 +81,170 @@ public:
 
   int16_t measureBothOnce(float &prs, float &temp, uint8_t prs_osr, uint8_t temp_osr);
 
+  /**
+   * @brief starts a combined temperature and pressure measurement (op mode CMD_BOTH)
+   * 
+   * @param prs_osr oversampling rate for pressure
+   * @param temp_osr oversampling rate for temperature
+   * @return status code
+   */
+  int16_t startMeasureBothOnce(uint8_t prs_osr, uint8_t temp_osr);
+
+  /**
+   * @brief reads the results of a combined measurement started before.
+   * Both results, the ready flags and INT_STS are read in one burst of the registers 0x00 - 0x0A;
+   * reading INT_STS also clears the ready interrupt.
+   * 
+   * @param prs reference to the pressure value
+   * @param temp reference to the temperature value
+   * @param restart 1 to start the next combined measurement as soon as the results are latched,
+   * before they are compensated
+   * @return status code, DPS__FAIL_UNFINISHED if the measurement is still running
+   */
+  int16_t getBothResults(float &prs, float &temp, uint8_t restart = 0U);
+
+  /**
+   * @brief returns back-to-back combined measurements at close to the maximum rate of the sensor.
+   * The first call starts a measurement; each call waits for the rest of the running measurement only,
+   * reads it and starts the next one right away, so the conversion runs while the caller works.
+   * Call standby() to stop.
+   * 
+   * @param prs reference to the pressure value
+   * @param temp reference to the temperature value
+   * @return status code
+   */
+  int16_t measureBothPipelined(float &prs, float &temp);
+
 protected:
   //compensation coefficients (for simplicity use 32 bits)
   float a_prime;
   float b_prime;
+  // a_prime and b_prime in 0.001 °C
+  int32_t m_aPrimeInt;
+  int32_t m_bPrimeInt;
   int32_t m_c02;
   int32_t m_c12;
 
+  // millis() when the running combined measurement has been started
+  unsigned long m_bothStartTime;
+
   /////// implement pure virtual functions ///////
   void init(void);
-  int16_t readcoeffs(void);
+  int16_t readcoeffs(const uint8_t *snapshot);
+  void foldTrim(void);
+
+  /**
+   * calculates m_prsPoly from the last temperature and the pressure oversampling rate
+   */
+  void foldTemp(void);
+  int16_t configBothCont(uint8_t tempCfg, uint8_t prsCfg, uint8_t tempShift, uint8_t prsShift);
   int16_t flushFIFO();
+  int16_t softReset(void);
+  int16_t getSensorReady(void);
+  int16_t getFIFOFillLevel(void);
   float calcTemp(int32_t raw);
   float calcPressure(int32_t raw);
+  int32_t calcTempInt(int32_t raw);
+  int32_t calcPressureInt(int32_t raw);
+};
+
+// compensation is defined inline, so that DpsSensor<Dps422Traits> can inline it into the FIFO drain loop
+
+inline float Dps422::calcTemp(int32_t raw)
+{
+  m_lastTempScal = (float)raw / 1048576;
+  m_lastTempRaw = raw;
+  m_lastTempScalValid = DPS__TEMP_SCAL_FLOAT;
+  //temperature changes much slower than pressure, so its terms are folded into the pressure polynomial once
+  foldTemp();
+  float u = m_lastTempScal / (1 + DPS422_ALPHA * m_lastTempScal);
+  return (m_k.t1 * u + m_k.t0);
+}
+
+inline void Dps422::foldTemp(void)
+{
+  //the last temperature has been measured by the integer compensation
+  if (!(m_lastTempScalValid & DPS__TEMP_SCAL_FLOAT))
+  {
+    m_lastTempScal = (float)m_lastTempRaw / 1048576;
+    m_lastTempScalValid |= DPS__TEMP_SCAL_FLOAT;
+  }
+  float temp = (8.5 * m_lastTempScal) / (1 + 8.8 * m_lastTempScal);
+  float s = 1.0f / scaling_facts[m_prsOsr];
+
+  //c00 + t * (c01 + t * c02) + p * (c10 + t * (c11 + t * c12) + p * (c20 + t * c21 + p * c30)) with p = raw * s
+  m_prsPoly[0] = m_k.c00 + temp * (m_k.c01 + temp * m_k.c02);
+  m_prsPoly[1] = (m_k.c10 + temp * (m_k.c11 + temp * m_k.c12)) * s;
+  m_prsPoly[2] = (m_k.c20 + temp * m_k.c21) * s * s;
+  m_prsPoly[3] = m_k.c30 * s * s * s;
+  m_prsPolyOsr = m_prsOsr;
+  m_lastTempScalValid |= DPS__TEMP_SCAL_POLY;
+}
+
+inline float Dps422::calcPressure(int32_t raw_prs)
+{
+  //temperature measured by the integer compensation, new oversampling rate or new trim
+  if (!(m_lastTempScalValid & DPS__TEMP_SCAL_POLY) || m_prsPolyOsr != m_prsOsr)
+  {
+    foldTemp();
+  }
+  float prs = raw_prs;
+
+  return m_prsPoly[0] + prs * (m_prsPoly[1] + prs * (m_prsPoly[2] + prs * m_prsPoly[3]));
+}
+
+inline int32_t Dps422::calcTempInt(int32_t raw)
+{
+  //scaled temperature raw / 2^20 as Q24 number
+  m_lastTempScalQ24 = raw * 16;
+  m_lastTempRaw = raw;
+  m_lastTempScalValid = DPS__TEMP_SCAL_Q24;
+  //u = t / (1 + alpha * t) as Q24 number, limited near the pole at t = -1 / alpha
+  int64_t t = m_lastTempScalQ24;
+  int64_t u = dps::divLimited(dps::toQ24(t), dps::toQ24(1) + dps::mulQ24(DPS422_ALPHA_Q24, t), dps::toQ24(32));
+  return dps::saturateInt32(dps::mulQ24(m_aPrimeInt, u) + m_kInt.t0);
+}
+
+inline int32_t Dps422::calcPressureInt(int32_t raw_prs)
+{
+  int32_t scaling = scaling_facts[m_prsOsr];
+  //scaled pressure as Q22 number
+  int64_t p = dps::divRound(dps::toQ22(raw_prs), scaling);
+
+  //the last temperature has been measured by the float compensation
+  if (!(m_lastTempScalValid & DPS__TEMP_SCAL_Q24))
+  {
+    m_lastTempScalQ24 = m_lastTempRaw * 16;
+    m_lastTempScalValid |= DPS__TEMP_SCAL_Q24;
+  }
+  //t = 8.5 * Tsc / (1 + 8.8 * Tsc) as Q22 number, limited near the pole at Tsc = -1 / 8.8
+  int64_t tsc = m_lastTempScalQ24;
+  int64_t t = dps::divLimited(dps::toQ22(tsc * 17 / 2), dps::toQ24(1) + tsc * 44 / 5, DPS__INT_SCALED_LIMIT);
+
+  //sum in Pa as Q16 number, Horner scheme in p and t
+  //c00 + c10 * p, the linear term exactly from the raw value
+  int64_t prs = m_kInt.c00 + dps::divRound(m_kInt.c10 * raw_prs, scaling);
+  //nonlinear terms as Q8 numbers; DpsFixedPoint.h shows that they stay in 64 bits for all raw values
+  //t * (c01 + t * c02)
+  prs += dps::mulQ22ToQ16(m_kInt.c01 + dps::mulQ22(m_kInt.c02, t), t);
+  //p * (t * (c11 + t * c12) + p * (c20 + t * c21 + p * c30))
+  int64_t x = m_kInt.c20 + dps::mulQ22(m_kInt.c21, t) + dps::mulQ22(m_kInt.c30, p);
+  x = dps::mulQ22(m_kInt.c11 + dps::mulQ22(m_kInt.c12, t), t) + dps::mulQ22(x, p);
+  prs += dps::mulQ22ToQ16(x, p);
+
+  //Q16 Pa to 0.01 Pa
+  return dps::saturateInt32((prs * DPS__INT_PRS_SCALE + (1 << 15)) >> 16);
+}
+
+/**
+ * @brief compile time description of the DPS422 for DpsSensor
+ */
+struct Dps422Traits
+{
+  typedef Dps422 Chip;
+
+  typedef dps422::FIFO_EMPTY FifoEmpty;
+  typedef dps422::FIFO_FULL FifoFull;
 };
 
 #endif
\ No newline at end of file
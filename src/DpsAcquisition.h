@@ -0,0 +1,215 @@
+/**
+ * @brief Double-buffered continuous acquisition
+ *
+ * DpsAcquisition drains the FIFO of a sensor in continuous mode into a buffer of raw values.
+ * When this buffer reaches the watermark, or the FIFO interrupt fires, the whole buffer is compensated
+ * at once into the result block, which is then handed to the application. Draining goes on into the
+ * raw buffer while the application works on the block, so the application never shares memory with the drain.
+ *
+ * The interrupt handler only calls onInterrupt(); the bus is accessed in update(), which is called from loop().
+ *
+ * @file DpsAcquisition.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSACQUISITION_H_INCLUDED
+#define DPSACQUISITION_H_INCLUDED
+
+#include "DpsClass.h"
+
+/**
+ * @tparam Sensor     Dps310, Dps422 or one of the DpsSensor types
+ * @tparam Capacity   number of samples per buffer
+ */
+template <class Sensor, uint8_t Capacity = DPS__FIFO_SIZE>
+class DpsAcquisition
+{
+public:
+  /**
+   * @brief compensated samples in the order they were measured
+   */
+  class Block
+  {
+  public:
+    /**
+     * @return number of samples in the block
+     */
+    uint8_t getCount(void) const
+    {
+      return m_count;
+    }
+
+    /**
+     * @return 1 if sample i is a pressure in Pa, 0 if it is a temperature in °C
+     */
+    uint8_t isPressure(uint8_t i) const
+    {
+      return (m_types[i >> 3] >> (i & 0x07U)) & 0x01U;
+    }
+
+    /**
+     * @return value of sample i
+     */
+    float getValue(uint8_t i) const
+    {
+      return m_values[i];
+    }
+
+    /**
+     * @return millis() when the block was completed
+     */
+    unsigned long getTime(void) const
+    {
+      return m_time;
+    }
+
+  private:
+    friend class DpsAcquisition;
+
+    float m_values[Capacity];
+    uint8_t m_types[(Capacity + 7U) / 8U];
+    uint8_t m_count;
+    unsigned long m_time;
+  };
+
+  /**
+   * @param &sensor: 	sensor with a running continuous measurement
+   */
+  explicit DpsAcquisition(Sensor &sensor)
+      : m_sensor(sensor), m_rawCount(0U), m_watermark(Capacity), m_interrupt(0U), m_swapRequest(0U),
+        m_blockState(BLOCK_FREE), m_stalls(0U)
+  {
+  }
+
+  /**
+   * sets the number of samples after which the raw buffer is compensated and handed over
+   *
+   * @param watermark: 	1 ... Capacity
+   */
+  void setWatermark(uint8_t watermark)
+  {
+    m_watermark = (watermark == 0U || watermark > Capacity) ? Capacity : watermark;
+  }
+
+  /**
+   * to be called from the handler of the FIFO interrupt; does not access the bus.
+   * The next update() hands over all samples drained so far.
+   */
+  void onInterrupt(void)
+  {
+    m_interrupt = 1U;
+  }
+
+  /**
+   * drains the FIFO into the raw buffer and hands it over as result block when it reaches the watermark
+   * or an interrupt occurred. If the application still holds the last block, the raw buffer keeps
+   * filling up; after that, new samples wait in the FIFO of the sensor.
+   *
+   * @return 	status code of the drain
+   */
+  int16_t update(void)
+  {
+    if (m_interrupt)
+    {
+      m_interrupt = 0U;
+      m_swapRequest = 1U;
+      //clear interrupt flag by reading
+      m_sensor.getIntStatusFifoFull();
+    }
+
+    int16_t ret = DPS__SUCCEEDED;
+    if (m_rawCount < Capacity)
+    {
+      uint8_t count = Capacity - m_rawCount;
+      ret = m_sensor.getContRawResults(&m_raw[m_rawCount], count);
+      m_rawCount += count;
+    }
+
+    if (m_rawCount > 0U && (m_rawCount >= m_watermark || m_swapRequest))
+    {
+      if (m_blockState == BLOCK_FREE)
+      {
+        swap();
+      }
+      else if (m_rawCount == Capacity)
+      {
+        m_stalls++;
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * returns the block of compensated samples that is ready, if there is one.
+   * The block belongs to the application until release() is called.
+   *
+   * @return 	the block or NULL
+   */
+  const Block *getBlock(void)
+  {
+    if (m_blockState != BLOCK_READY)
+    {
+      return NULL;
+    }
+    m_blockState = BLOCK_IN_USE;
+    return &m_block;
+  }
+
+  /**
+   * gives the block back, so that the next one can be handed over
+   */
+  void release(void)
+  {
+    m_blockState = BLOCK_FREE;
+  }
+
+  /**
+   * @return 	number of updates that found the raw buffer full while the application held the block;
+   * 			a growing number means that blocks are released too late
+   */
+  uint16_t getStalls(void) const
+  {
+    return m_stalls;
+  }
+
+private:
+  enum BlockState_e
+  {
+    BLOCK_FREE,
+    BLOCK_READY,
+    BLOCK_IN_USE,
+  };
+
+  /**
+   * compensates the raw buffer into the result block in one pass and empties the raw buffer
+   */
+  void swap(void)
+  {
+    memset(m_block.m_types, 0, sizeof(m_block.m_types));
+    //FIFO order, so that each pressure is compensated with the temperature measured before it
+    for (uint8_t i = 0; i < m_rawCount; i++)
+    {
+      m_block.m_values[i] = m_sensor.compensate(m_raw[i]);
+      m_block.m_types[i >> 3] |= (uint8_t)((m_raw[i] & 0x01) << (i & 0x07U));
+    }
+    m_block.m_count = m_rawCount;
+    m_block.m_time = millis();
+    m_rawCount = 0U;
+    m_swapRequest = 0U;
+    m_blockState = BLOCK_READY;
+  }
+
+  Sensor &m_sensor;
+
+  int32_t m_raw[Capacity];
+  uint8_t m_rawCount;
+  uint8_t m_watermark;
+  volatile uint8_t m_interrupt;
+  uint8_t m_swapRequest;
+
+  Block m_block;
+  uint8_t m_blockState;
+  uint16_t m_stalls;
+};
+
+#endif //DPSACQUISITION_H_INCLUDED
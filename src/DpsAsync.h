@@ -0,0 +1,479 @@
+/**
+ * @brief Awaitable measurements with C++20 coroutines
+ *
+ * Instead of waiting in delay() like measureTempOnce()/measurePressureOnce(), a coroutine suspends
+ * while the sensor converts, and a dps::EventLoop resumes it when the conversion time has passed
+ * or the FIFO interrupt has fired. One thread can drive many sensors this way:
+ *
+ *   dps::Task readSensor(DpsAsync<Dps310> &sensor)
+ *   {
+ *     dps::Measurement prs = co_await sensor.measurePressure(DPS__OVERSAMPLING_RATE_8);
+ *     ...
+ *   }
+ *
+ * Only available if the compiler supports coroutines (e.g. -std=c++20 on Linux hosts or ESP32);
+ * otherwise this header is empty.
+ *
+ * @file DpsAsync.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSASYNC_H_INCLUDED
+#define DPSASYNC_H_INCLUDED
+
+#if defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#define DPS_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef DPS_HAS_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include "DpsClass.h"
+
+// maximum number of coroutines waiting in one event loop
+#ifndef DPS__ASYNC_MAX_WAITS
+#define DPS__ASYNC_MAX_WAITS 32
+#endif
+
+// number of interrupt lines an event loop can distinguish
+#define DPS__ASYNC_INTERRUPT_LINES 32
+
+namespace dps
+{
+
+/**
+ * @brief coroutine type for functions that co_await sensors
+ *
+ * The coroutine starts immediately and runs until its first co_await.
+ * The Task object owns the coroutine: it has to live until done() returns true.
+ */
+class Task
+{
+public:
+  struct promise_type
+  {
+    Task get_return_object()
+    {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_never initial_suspend() noexcept
+    {
+      return {};
+    }
+
+    //keep the frame until the Task is destroyed, so that done() can be asked
+    std::suspend_always final_suspend() noexcept
+    {
+      return {};
+    }
+
+    void return_void()
+    {
+    }
+
+    void unhandled_exception()
+    {
+      std::terminate();
+    }
+  };
+
+  Task(Task &&other) noexcept : m_handle(other.m_handle)
+  {
+    other.m_handle = nullptr;
+  }
+
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+
+  ~Task()
+  {
+    if (m_handle)
+    {
+      m_handle.destroy();
+    }
+  }
+
+  /**
+   * @return true if the coroutine has returned
+   */
+  bool done() const
+  {
+    return !m_handle || m_handle.done();
+  }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle)
+  {
+  }
+
+  std::coroutine_handle<promise_type> m_handle;
+};
+
+/**
+ * @brief resumes waiting coroutines when their time has come or their interrupt line fired
+ *
+ * Everything runs in the thread that calls run() or poll(); only notify() may be called
+ * from an interrupt handler or another thread.
+ */
+class EventLoop
+{
+public:
+  EventLoop() : m_count(0U), m_pending(0U)
+  {
+  }
+
+  virtual ~EventLoop()
+  {
+  }
+
+  /**
+   * marks an interrupt line as fired; safe to call from interrupt handlers
+   *
+   * @param line: 	0 ... DPS__ASYNC_INTERRUPT_LINES - 1
+   */
+  void notify(uint8_t line)
+  {
+    m_pending.fetch_or((uint32_t)1U << line, std::memory_order_release);
+  }
+
+  /**
+   * resumes all coroutines that are due, without waiting
+   *
+   * @return 	number of coroutines that are still waiting
+   */
+  uint8_t poll()
+  {
+    unsigned long now = millis();
+    uint32_t pending = m_pending.load(std::memory_order_acquire);
+    uint32_t consumed = 0U;
+    std::coroutine_handle<> ready[DPS__ASYNC_MAX_WAITS];
+    uint8_t readyCount = 0U;
+    //collect first, resumed coroutines may add new waits
+    for (uint8_t i = 0; i < m_count;)
+    {
+      Wait &wait = m_waits[i];
+      uint8_t fired = wait.line >= 0 && ((pending >> wait.line) & 0x01U);
+      if (fired || (long)(now - wait.deadline) >= 0)
+      {
+        if (fired)
+        {
+          consumed |= (uint32_t)1U << wait.line;
+        }
+        ready[readyCount++] = wait.handle;
+        m_waits[i] = m_waits[--m_count];
+      }
+      else
+      {
+        i++;
+      }
+    }
+    //interrupts nobody waited for stay pending for the next wait
+    m_pending.fetch_and(~consumed, std::memory_order_acq_rel);
+    for (uint8_t i = 0; i < readyCount; i++)
+    {
+      ready[i].resume();
+    }
+    return m_count;
+  }
+
+  /**
+   * resumes coroutines until none is waiting anymore
+   */
+  void run()
+  {
+    while (poll())
+    {
+      unsigned long now = millis();
+      unsigned long next = m_waits[0].deadline;
+      for (uint8_t i = 1; i < m_count; i++)
+      {
+        if ((long)(m_waits[i].deadline - next) < 0)
+        {
+          next = m_waits[i].deadline;
+        }
+      }
+      if ((long)(next - now) > 0)
+      {
+        idle(next - now);
+      }
+    }
+  }
+
+  /**
+   * lets a coroutine wait until a deadline or until an interrupt line fires, whatever happens first
+   *
+   * @param handle: 	the coroutine
+   * @param deadline: 	millis() after which the coroutine is resumed
+   * @param line: 		interrupt line, -1 for none
+   * @return 	false if too many coroutines are waiting
+   */
+  bool wait(std::coroutine_handle<> handle, unsigned long deadline, int8_t line = -1)
+  {
+    if (m_count >= DPS__ASYNC_MAX_WAITS)
+    {
+      return false;
+    }
+    m_waits[m_count].handle = handle;
+    m_waits[m_count].deadline = deadline;
+    m_waits[m_count].line = line;
+    m_count++;
+    return true;
+  }
+
+protected:
+  /**
+   * waits for the next deadline; returns earlier if an interrupt line somebody waits for fires.
+   * Override it to sleep on other event sources, e.g. GPIO file descriptors.
+   *
+   * @param maxTime: 	time until the next deadline in ms
+   */
+  virtual void idle(unsigned long maxTime)
+  {
+    unsigned long start = millis();
+    while (!interruptPending() && millis() - start < maxTime)
+    {
+      delay(1);
+    }
+  }
+
+  /**
+   * @return 	true if an interrupt line fired that a coroutine waits for
+   */
+  bool interruptPending() const
+  {
+    uint32_t pending = m_pending.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+      if (m_waits[i].line >= 0 && ((pending >> m_waits[i].line) & 0x01U))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  struct Wait
+  {
+    std::coroutine_handle<> handle;
+    unsigned long deadline;
+    int8_t line;
+  };
+
+  Wait m_waits[DPS__ASYNC_MAX_WAITS];
+  uint8_t m_count;
+  std::atomic<uint32_t> m_pending;
+};
+
+/**
+ * @brief result of an awaited single measurement
+ */
+struct Measurement
+{
+  int16_t status; //status code like measureTempOnce
+  float value;    //°C or Pa
+};
+
+/**
+ * @brief results of an awaited FIFO drain, in the order they were measured
+ */
+struct Batch
+{
+  int16_t status; //status code like getContResults
+  uint8_t count;
+  int32_t raw[DPS__FIFO_SIZE];
+  float values[DPS__FIFO_SIZE];
+
+  /**
+   * @return 1 if result i is a pressure in Pa, 0 if it is a temperature in °C
+   */
+  uint8_t isPressure(uint8_t i) const
+  {
+    return raw[i] & 0x01;
+  }
+};
+
+} // namespace dps
+
+/**
+ * @brief awaitable measurements of one sensor, driven by a dps::EventLoop
+ *
+ * @tparam Sensor 	Dps310, Dps422 or one of the DpsSensor types
+ */
+template <class Sensor>
+class DpsAsync
+{
+public:
+  /**
+   * @param &sensor: 			initialized sensor
+   * @param &loop: 				event loop that resumes the waiting coroutines
+   * @param interruptLine: 		line the interrupt handler of this sensor passes to loop.notify(), -1 if the interrupt is not used
+   */
+  DpsAsync(Sensor &sensor, dps::EventLoop &loop, int8_t interruptLine = -1)
+      : m_sensor(sensor), m_loop(loop), m_interruptLine(interruptLine), m_pollInterval(100U)
+  {
+  }
+
+  /**
+   * sets how long nextBatch() waits for the interrupt before it drains the FIFO anyway;
+   * without interrupt, this is the time between drains
+   *
+   * @param pollInterval: 	time in ms
+   */
+  void setPollInterval(unsigned long pollInterval)
+  {
+    m_pollInterval = pollInterval;
+  }
+
+  /**
+   * @brief awaiter of a single measurement
+   */
+  class MeasureAwaiter
+  {
+  public:
+    MeasureAwaiter(DpsAsync &async, dps::Mode mode, uint8_t oversamplingRate)
+        : m_async(async), m_mode(mode), m_osr(oversamplingRate), m_status(DPS__SUCCEEDED)
+    {
+    }
+
+    //the measurement is started here; if that fails, the coroutine does not suspend
+    bool await_ready()
+    {
+      Sensor &sensor = m_async.m_sensor;
+      m_status = m_mode == dps::CMD_TEMP ? sensor.startMeasureTempOnce(m_osr) : sensor.startMeasurePressureOnce(m_osr);
+      return m_status != DPS__SUCCEEDED;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+      //conversion time as in measureTempOnce, including the failsafe time
+      unsigned long busyTime = dps::busyTime(0U, m_osr) / DPS__BUSYTIME_SCALING + DPS310__BUSYTIME_FAILSAFE;
+      if (!m_async.m_loop.wait(handle, millis() + busyTime))
+      {
+        m_async.m_sensor.standby();
+        m_status = DPS__FAIL_TOOBUSY;
+        return false;
+      }
+      return true;
+    }
+
+    dps::Measurement await_resume()
+    {
+      dps::Measurement result = {m_status, 0.0f};
+      if (m_status == DPS__SUCCEEDED)
+      {
+        result.status = m_async.m_sensor.getSingleResult(result.value);
+        if (result.status != DPS__SUCCEEDED)
+        {
+          m_async.m_sensor.standby();
+        }
+      }
+      return result;
+    }
+
+  private:
+    DpsAsync &m_async;
+    dps::Mode m_mode;
+    uint8_t m_osr;
+    int16_t m_status;
+  };
+
+  /**
+   * @brief awaiter of the next FIFO drain
+   */
+  class BatchAwaiter
+  {
+  public:
+    explicit BatchAwaiter(DpsAsync &async) : m_async(async), m_status(DPS__SUCCEEDED)
+    {
+    }
+
+    bool await_ready()
+    {
+      return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+      if (!m_async.m_loop.wait(handle, millis() + m_async.m_pollInterval, m_async.m_interruptLine))
+      {
+        m_status = DPS__FAIL_TOOBUSY;
+        return false;
+      }
+      return true;
+    }
+
+    dps::Batch await_resume()
+    {
+      dps::Batch batch;
+      batch.count = 0U;
+      batch.status = m_status;
+      if (m_status != DPS__SUCCEEDED)
+      {
+        return batch;
+      }
+      Sensor &sensor = m_async.m_sensor;
+      if (m_async.m_interruptLine >= 0)
+      {
+        //clear interrupt flag by reading
+        sensor.getIntStatusFifoFull();
+      }
+      batch.count = DPS__FIFO_SIZE;
+      batch.status = sensor.getContRawResults(batch.raw, batch.count);
+      //FIFO order, so that each pressure is compensated with the temperature measured before it
+      for (uint8_t i = 0; i < batch.count; i++)
+      {
+        batch.values[i] = sensor.compensate(batch.raw[i]);
+      }
+      return batch;
+    }
+
+  private:
+    DpsAsync &m_async;
+    int16_t m_status;
+  };
+
+  /**
+   * performs one temperature measurement; co_await returns a dps::Measurement
+   *
+   * @param oversamplingRate: 	DPS__OVERSAMPLING_RATE_1 ... DPS__OVERSAMPLING_RATE_128
+   */
+  MeasureAwaiter measureTemp(uint8_t oversamplingRate)
+  {
+    return MeasureAwaiter(*this, dps::CMD_TEMP, oversamplingRate);
+  }
+
+  /**
+   * performs one pressure measurement; co_await returns a dps::Measurement
+   *
+   * @param oversamplingRate: 	DPS__OVERSAMPLING_RATE_1 ... DPS__OVERSAMPLING_RATE_128
+   */
+  MeasureAwaiter measurePressure(uint8_t oversamplingRate)
+  {
+    return MeasureAwaiter(*this, dps::CMD_PRS, oversamplingRate);
+  }
+
+  /**
+   * waits for the FIFO interrupt or the poll interval and drains the FIFO of a continuous measurement;
+   * co_await returns a dps::Batch
+   */
+  BatchAwaiter nextBatch()
+  {
+    return BatchAwaiter(*this);
+  }
+
+private:
+  Sensor &m_sensor;
+  dps::EventLoop &m_loop;
+  int8_t m_interruptLine;
+  unsigned long m_pollInterval;
+};
+
+#endif //DPS_HAS_COROUTINES
+
+#endif //DPSASYNC_H_INCLUDED
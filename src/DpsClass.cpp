@@ -1,4 +1,5 @@
 #include "DpsClass.h"
+#include "util/DpsFixedPoint.h"
 using namespace dps;
 
 const int32_t DpsClass::scaling_facts[DPS__NUM_OF_SCAL_FACTS] = {524288, 1572864, 3670016, 7864320, 253952, 516096, 1040384, 2088960};
@@ -9,11 +10,38 @@ DpsClass::DpsClass(void)
 {
 	//assume that initialization has failed before it has been done
 	m_initFail = 1U;
+	m_busFailures = 0U;
+	m_recovering = 0U;
+	m_recoveries = 0U;
+	m_cfgShadowValid = 0U;
+	m_cfgInSync = 1U;
+	m_pausedMode = IDLE;
+	m_lastTempScal = 0.0f;
+	m_lastTempScalQ24 = 0;
+	m_lastTempRaw = 0;
+	m_lastTempOsr = 0U;
+	m_prsPolyOsr = 0U;
+	m_mux = NULL;
+	m_muxChannel = 0U;
+	m_lastTempScalValid = DPS__TEMP_SCAL_FLOAT | DPS__TEMP_SCAL_Q24;
+	m_trim.prsOffset = 0.0f;
+	m_trim.prsGain = 1.0f;
+	m_trim.prsTempCoeff = 0.0f;
+	m_trim.tempOffset = 0.0f;
+	resetFifoStats();
+#ifdef DPS_ENABLE_BUS_STATS
+	resetBusStats();
+#endif
 }
 
 DpsClass::~DpsClass(void)
 {
-	end();
+	//end() cannot be used here, since the FIFO handling of the derived classes is already gone
+	//stop measurements only
+	if (!m_initFail)
+	{
+		setOpMode(IDLE);
+	}
 }
 
 void DpsClass::begin(TwoWire &bus)
@@ -23,8 +51,33 @@ void DpsClass::begin(TwoWire &bus)
 
 void DpsClass::begin(TwoWire &bus, uint8_t slaveAddress)
 {
+	m_mux = NULL;
+	beginI2C(bus, slaveAddress);
+}
+
+void DpsClass::begin(DpsI2cMux &mux, uint8_t channel, uint8_t slaveAddress)
+{
+	m_mux = &mux;
+	m_muxChannel = channel;
+	//the control register is unknown after a reset of the multiplexer
+	mux.invalidate();
+	beginI2C(mux.getBus(), slaveAddress);
+}
+
+void DpsClass::beginI2C(TwoWire &bus, uint8_t slaveAddress)
+{
+	DPS_API_SCOPE(API_BEGIN);
 	//this flag will show if the initialization was successful
 	m_initFail = 0U;
+	m_busFailures = 0U;
+	m_recoveries = 0U;
+	m_cfgShadowValid = 0U;
+	m_cfgInSync = 1U;
+	m_pausedMode = IDLE;
+	resetFifoStats();
+#ifdef DPS_ENABLE_BUS_STATS
+	resetBusStats();
+#endif
 
 	//Set I2C bus connection
 	m_SpiI2c = 1U;
@@ -49,11 +102,22 @@ void DpsClass::begin(SPIClass &bus, int32_t chipSelect)
 #ifndef DPS_DISABLESPI
 void DpsClass::begin(SPIClass &bus, int32_t chipSelect, uint8_t threeWire)
 {
+	DPS_API_SCOPE(API_BEGIN);
 	//this flag will show if the initialization was successful
 	m_initFail = 0U;
+	m_busFailures = 0U;
+	m_recoveries = 0U;
+	m_cfgShadowValid = 0U;
+	m_cfgInSync = 1U;
+	m_pausedMode = IDLE;
+	resetFifoStats();
+#ifdef DPS_ENABLE_BUS_STATS
+	resetBusStats();
+#endif
 
 	//Set SPI bus connection
 	m_SpiI2c = 0U;
+	m_mux = NULL;
 	m_spibus = &bus;
 	m_chipSelect = chipSelect;
 
@@ -83,8 +147,41 @@ void DpsClass::begin(SPIClass &bus, int32_t chipSelect, uint8_t threeWire)
 }
 #endif
 
+void DpsClass::begin(DpsTransport &transport)
+{
+	DPS_API_SCOPE(API_BEGIN);
+	//this flag will show if the initialization was successful
+	m_initFail = 0U;
+	m_busFailures = 0U;
+	m_recoveries = 0U;
+	m_cfgShadowValid = 0U;
+	m_cfgInSync = 1U;
+	m_pausedMode = IDLE;
+	resetFifoStats();
+#ifdef DPS_ENABLE_BUS_STATS
+	resetBusStats();
+#endif
+
+	//Set bus connection
+	m_SpiI2c = 2U;
+	m_mux = NULL;
+	m_transport = &transport;
+
+	// Init bus
+	if (m_transport->begin() != DPS__SUCCEEDED)
+	{
+		m_initFail = 1U;
+		return;
+	}
+
+	delay(50); //startup time of Dps310
+
+	init();
+}
+
 void DpsClass::end(void)
 {
+	DPS_API_SCOPE(API_END);
 	standby();
 }
 
@@ -100,105 +197,52 @@ uint8_t DpsClass::getRevisionId(void)
 	return m_revisionID;
 }
 
-int16_t DpsClass::getContResults(float *tempBuffer,
-								 uint8_t &tempCount,
-								 float *prsBuffer,
-								 uint8_t &prsCount, RegMask_t fifo_empty_reg)
+int16_t DpsClass::getSingleResult(float &result)
 {
-	if (m_initFail)
+	int32_t raw_val;
+	Mode mode;
+	int16_t ret = getSingleRawResult(raw_val, mode);
+	if (ret == DPS__SUCCEEDED)
 	{
-		return DPS__FAIL_INIT_FAILED;
-	}
-	//abort if device is not in background mode
-	if (!(m_opMode & 0x04))
-	{
-		return DPS__FAIL_TOOBUSY;
+		result = mode == CMD_TEMP ? calcTemp(raw_val) : calcPressure(raw_val);
 	}
+	return ret;
+}
 
-	if (!tempBuffer || !prsBuffer)
+int16_t DpsClass::getSingleResult(int32_t &result)
+{
+	int32_t raw_val;
+	Mode mode;
+	int16_t ret = getSingleRawResult(raw_val, mode);
+	if (ret == DPS__SUCCEEDED)
 	{
-		return DPS__FAIL_UNKNOWN;
+		result = mode == CMD_TEMP ? calcTempInt(raw_val) : calcPressureInt(raw_val);
 	}
-	tempCount = 0U;
-	prsCount = 0U;
-
-	//while FIFO is not empty
-	while (readByteBitfield(fifo_empty_reg) == 0)
-	{
-		int32_t raw_result;
-		float result;
-		//read next result from FIFO
-		int16_t type = getFIFOvalue(&raw_result);
-		switch (type)
-		{
-		case 0: //temperature
-			if (tempCount < DPS__FIFO_SIZE)
-			{
-				result = calcTemp(raw_result);
-				tempBuffer[tempCount++] = result;
-			}
-			break;
-		case 1: //pressure
-			if (prsCount < DPS__FIFO_SIZE)
-			{
-				result = calcPressure(raw_result);
-				prsBuffer[prsCount++] = result;
-			}
-			break;
-		case -1: //read failed
-			break;
-		}
-	}
-	return DPS__SUCCEEDED;
+	return ret;
 }
 
-int16_t DpsClass::getSingleResult(float &result)
+int16_t DpsClass::getReadyResult(float &result)
 {
-	//abort if initialization failed
-	if (m_initFail)
+	int32_t raw_val;
+	Mode mode;
+	int16_t ret = getReadyRawResult(raw_val, mode);
+	if (ret == DPS__SUCCEEDED)
 	{
-		return DPS__FAIL_INIT_FAILED;
+		result = mode == CMD_TEMP ? calcTemp(raw_val) : calcPressure(raw_val);
 	}
+	return ret;
+}
 
-	//read finished bit for current opMode
-	int16_t rdy;
-	switch (m_opMode)
-	{
-	case CMD_TEMP: //temperature
-		rdy = readByteBitfield(config_registers[TEMP_RDY]);
-		break;
-	case CMD_PRS: //pressure
-		rdy = readByteBitfield(config_registers[PRS_RDY]);
-		break;
-	default: //DPS310 not in command mode
-		return DPS__FAIL_TOOBUSY;
-	}
-	//read new measurement result
-	switch (rdy)
+int16_t DpsClass::getReadyResult(int32_t &result)
+{
+	int32_t raw_val;
+	Mode mode;
+	int16_t ret = getReadyRawResult(raw_val, mode);
+	if (ret == DPS__SUCCEEDED)
 	{
-	case DPS__FAIL_UNKNOWN: //could not read ready flag
-		return DPS__FAIL_UNKNOWN;
-	case 0: //ready flag not set, measurement still in progress
-		return DPS__FAIL_UNFINISHED;
-	case 1: //measurement ready, expected case
-		Mode oldMode = m_opMode;
-		m_opMode = IDLE; //opcode was automatically reseted by DPS310
-		int32_t raw_val;
-		switch (oldMode)
-		{
-		case CMD_TEMP: //temperature
-			getRawResult(&raw_val, registerBlocks[TEMP]);
-			result = calcTemp(raw_val);
-			return DPS__SUCCEEDED; // TODO
-		case CMD_PRS:			   //pressure
-			getRawResult(&raw_val, registerBlocks[PRS]);
-			result = calcPressure(raw_val);
-			return DPS__SUCCEEDED; // TODO
-		default:
-			return DPS__FAIL_UNKNOWN; //should already be filtered above
-		}
+		result = mode == CMD_TEMP ? calcTempInt(raw_val) : calcPressureInt(raw_val);
 	}
-	return DPS__FAIL_UNKNOWN;
+	return ret;
 }
 
 int16_t DpsClass::measureTempOnce(float &result)
@@ -208,21 +252,29 @@ int16_t DpsClass::measureTempOnce(float &result)
 
 int16_t DpsClass::measureTempOnce(float &result, uint8_t oversamplingRate)
 {
-	//Start measurement
-	int16_t ret = startMeasureTempOnce(oversamplingRate);
-	if (ret != DPS__SUCCEEDED)
+	DPS_API_SCOPE(API_MEASURE_TEMP_ONCE);
+	int32_t raw_val;
+	int16_t ret = measureRawOnce(raw_val, CMD_TEMP, oversamplingRate);
+	if (ret == DPS__SUCCEEDED)
 	{
-		return ret;
+		result = calcTemp(raw_val);
 	}
+	return ret;
+}
 
-	//wait until measurement is finished
-	delay(calcBusyTime(0U, m_tempOsr) / DPS__BUSYTIME_SCALING);
-	delay(DPS310__BUSYTIME_FAILSAFE);
+int16_t DpsClass::measureTempOnce(int32_t &result)
+{
+	return measureTempOnce(result, m_tempOsr);
+}
 
-	ret = getSingleResult(result);
-	if (ret != DPS__SUCCEEDED)
+int16_t DpsClass::measureTempOnce(int32_t &result, uint8_t oversamplingRate)
+{
+	DPS_API_SCOPE(API_MEASURE_TEMP_ONCE);
+	int32_t raw_val;
+	int16_t ret = measureRawOnce(raw_val, CMD_TEMP, oversamplingRate);
+	if (ret == DPS__SUCCEEDED)
 	{
-		standby();
+		result = calcTempInt(raw_val);
 	}
 	return ret;
 }
@@ -234,6 +286,7 @@ int16_t DpsClass::startMeasureTempOnce(void)
 
 int16_t DpsClass::startMeasureTempOnce(uint8_t oversamplingRate)
 {
+	DPS_API_SCOPE(API_START_MEASURE_TEMP_ONCE);
 	//abort if initialization failed
 	if (m_initFail)
 	{
@@ -245,6 +298,7 @@ int16_t DpsClass::startMeasureTempOnce(uint8_t oversamplingRate)
 		return DPS__FAIL_TOOBUSY;
 	}
 
+	BusBatch batch(*this);
 	if (oversamplingRate != m_tempOsr)
 	{
 		//configuration of oversampling rate
@@ -265,21 +319,29 @@ int16_t DpsClass::measurePressureOnce(float &result)
 
 int16_t DpsClass::measurePressureOnce(float &result, uint8_t oversamplingRate)
 {
-	//start the measurement
-	int16_t ret = startMeasurePressureOnce(oversamplingRate);
-	if (ret != DPS__SUCCEEDED)
+	DPS_API_SCOPE(API_MEASURE_PRESSURE_ONCE);
+	int32_t raw_val;
+	int16_t ret = measureRawOnce(raw_val, CMD_PRS, oversamplingRate);
+	if (ret == DPS__SUCCEEDED)
 	{
-		return ret;
+		result = calcPressure(raw_val);
 	}
+	return ret;
+}
 
-	//wait until measurement is finished
-	delay(calcBusyTime(0U, m_prsOsr) / DPS__BUSYTIME_SCALING);
-	delay(DPS310__BUSYTIME_FAILSAFE);
+int16_t DpsClass::measurePressureOnce(int32_t &result)
+{
+	return measurePressureOnce(result, m_prsOsr);
+}
 
-	ret = getSingleResult(result);
-	if (ret != DPS__SUCCEEDED)
+int16_t DpsClass::measurePressureOnce(int32_t &result, uint8_t oversamplingRate)
+{
+	DPS_API_SCOPE(API_MEASURE_PRESSURE_ONCE);
+	int32_t raw_val;
+	int16_t ret = measureRawOnce(raw_val, CMD_PRS, oversamplingRate);
+	if (ret == DPS__SUCCEEDED)
 	{
-		standby();
+		result = calcPressureInt(raw_val);
 	}
 	return ret;
 }
@@ -291,6 +353,7 @@ int16_t DpsClass::startMeasurePressureOnce(void)
 
 int16_t DpsClass::startMeasurePressureOnce(uint8_t oversamplingRate)
 {
+	DPS_API_SCOPE(API_START_MEASURE_PRESSURE_ONCE);
 	//abort if initialization failed
 	if (m_initFail)
 	{
@@ -301,6 +364,7 @@ int16_t DpsClass::startMeasurePressureOnce(uint8_t oversamplingRate)
 	{
 		return DPS__FAIL_TOOBUSY;
 	}
+	BusBatch batch(*this);
 	//configuration of oversampling rate, lowest measure rate to avoid conflicts
 	if (oversamplingRate != m_prsOsr)
 	{
@@ -315,6 +379,7 @@ int16_t DpsClass::startMeasurePressureOnce(uint8_t oversamplingRate)
 
 int16_t DpsClass::startMeasureTempCont(uint8_t measureRate, uint8_t oversamplingRate)
 {
+	DPS_API_SCOPE(API_START_MEASURE_TEMP_CONT);
 	//abort if initialization failed
 	if (m_initFail)
 	{
@@ -330,6 +395,7 @@ int16_t DpsClass::startMeasureTempCont(uint8_t measureRate, uint8_t oversampling
 	{
 		return DPS__FAIL_UNFINISHED;
 	}
+	BusBatch batch(*this);
 	//update precision and measuring rate
 	if (configTemp(measureRate, oversamplingRate))
 	{
@@ -350,6 +416,7 @@ int16_t DpsClass::startMeasureTempCont(uint8_t measureRate, uint8_t oversampling
 
 int16_t DpsClass::startMeasurePressureCont(uint8_t measureRate, uint8_t oversamplingRate)
 {
+	DPS_API_SCOPE(API_START_MEASURE_PRESSURE_CONT);
 	//abort if initialization failed
 	if (m_initFail)
 	{
@@ -365,6 +432,7 @@ int16_t DpsClass::startMeasurePressureCont(uint8_t measureRate, uint8_t oversamp
 	{
 		return DPS__FAIL_UNFINISHED;
 	}
+	BusBatch batch(*this);
 	//update precision and measuring rate
 	if (configPressure(measureRate, oversamplingRate))
 		return DPS__FAIL_UNKNOWN;
@@ -386,6 +454,7 @@ int16_t DpsClass::startMeasureBothCont(uint8_t tempMr,
 									   uint8_t prsMr,
 									   uint8_t prsOsr)
 {
+	DPS_API_SCOPE(API_START_MEASURE_BOTH_CONT);
 	//abort if initialization failed
 	if (m_initFail)
 	{
@@ -401,6 +470,7 @@ int16_t DpsClass::startMeasureBothCont(uint8_t tempMr,
 	{
 		return DPS__FAIL_UNFINISHED;
 	}
+	BusBatch batch(*this);
 	//update precision and measuring rate
 	if (configTemp(tempMr, tempOsr))
 	{
@@ -424,32 +494,85 @@ int16_t DpsClass::startMeasureBothCont(uint8_t tempMr,
 
 int16_t DpsClass::standby(void)
 {
+	DPS_API_SCOPE(API_STANDBY);
 	//abort if initialization failed
 	if (m_initFail)
 	{
 		return DPS__FAIL_INIT_FAILED;
 	}
+	BusBatch batch(*this);
 	//set device to idling mode
 	int16_t ret = setOpMode(IDLE);
 	if (ret != DPS__SUCCEEDED)
 	{
 		return ret;
 	}
+	m_pausedMode = IDLE;
 	ret = disableFIFO();
+	if (batch.end() != DPS__SUCCEEDED)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
 	return ret;
 }
 
+int16_t DpsClass::pause(void)
+{
+	DPS_API_SCOPE(API_PAUSE);
+	//abort if initialization failed
+	if (m_initFail)
+	{
+		return DPS__FAIL_INIT_FAILED;
+	}
+	//only background measurements can be resumed
+	if (!(m_opMode & 0x04))
+	{
+		return DPS__FAIL_TOOBUSY;
+	}
+	Mode mode = m_opMode;
+	BusBatch batch(*this);
+	int16_t ret = setOpMode(IDLE);
+	//results left in the FIFO would be taken for the first ones after resume()
+	if (ret == DPS__SUCCEEDED)
+	{
+		ret = flushFIFO();
+	}
+	if (batch.end() != DPS__SUCCEEDED)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	if (ret == DPS__SUCCEEDED)
+	{
+		m_pausedMode = mode;
+	}
+	return ret;
+}
+
+int16_t DpsClass::resume(void)
+{
+	DPS_API_SCOPE(API_RESUME);
+	//abort if initialization failed
+	if (m_initFail)
+	{
+		return DPS__FAIL_INIT_FAILED;
+	}
+	if (m_opMode != IDLE || m_pausedMode == IDLE)
+	{
+		return DPS__FAIL_TOOBUSY;
+	}
+	//configuration and FIFO are unchanged, only the operating mode is written
+	return setOpMode(m_pausedMode);
+}
+
 int16_t DpsClass::correctTemp(void)
 {
+	DPS_API_SCOPE(API_CORRECT_TEMP);
 	if (m_initFail)
 	{
 		return DPS__FAIL_INIT_FAILED;
 	}
-	writeByte(0x0E, 0xA5);
-	writeByte(0x0F, 0x96);
-	writeByte(0x62, 0x02);
-	writeByte(0x0E, 0x00);
-	writeByte(0x0F, 0x00);
+	BusBatch batch(*this);
+	writeTempCorrection();
 
 	//perform a first temperature measurement (again)
 	//the most recent temperature will be saved internally
@@ -460,30 +583,403 @@ int16_t DpsClass::correctTemp(void)
 	return DPS__SUCCEEDED;
 }
 
+int16_t DpsClass::recover(void)
+{
+	DPS_API_SCOPE(API_RECOVER);
+	//without a successful begin() there is nothing to restore
+	if (m_initFail)
+	{
+		return DPS__FAIL_INIT_FAILED;
+	}
+	m_recovering = 1U;
+	Mode resumeMode = m_opMode;
+
+	int16_t ret = recoverBus();
+	if (ret == DPS__SUCCEEDED)
+	{
+		ret = softReset();
+	}
+	//the registers are at their reset values until the configuration has been restored below;
+	//the cache is kept for the restore, but must not replace reads or writes until then
+	if (ret == DPS__SUCCEEDED)
+	{
+		m_cfgInSync = 0U;
+	}
+#ifndef DPS_DISABLESPI
+	//the sensor is back in 4-wire mode and cannot answer until 3-wire mode is restored
+	if (ret == DPS__SUCCEEDED && m_SpiI2c == 0 && m_threeWire)
+	{
+		delay(DPS__RESET_TIMEOUT);
+		ret = writeByte(DPS310__REG_ADR_SPI3W, m_cfgShadow[DPS310__REG_ADR_SPI3W - DPS__CFG_SHADOW_START]);
+	}
+#endif
+	//wait until the sensor has loaded its coefficients
+	if (ret == DPS__SUCCEEDED)
+	{
+		unsigned long startTime = millis();
+		while ((ret = getSensorReady()) != 1)
+		{
+			if (millis() - startTime > DPS__RESET_TIMEOUT)
+			{
+				ret = DPS__FAIL_UNFINISHED;
+				break;
+			}
+			delay(1);
+		}
+		ret = ret == 1 ? DPS__SUCCEEDED : ret;
+	}
+
+	//restore the configuration from the cache; the coefficients are still known
+	//the operating mode is restored last, since it starts the measurement
+	if (ret == DPS__SUCCEEDED)
+	{
+		BusBatch batch(*this);
+		for (uint8_t i = 0; i < DPS__CFG_SHADOW_LENGTH && ret == DPS__SUCCEEDED; i++)
+		{
+			if (DPS__CFG_SHADOW_START + i != MSR_CTRL::regAddress && (m_cfgShadowValid & (1U << i)))
+			{
+				ret = writeByte(DPS__CFG_SHADOW_START + i, m_cfgShadow[i]);
+			}
+		}
+		if (ret == DPS__SUCCEEDED)
+		{
+			m_cfgInSync = 1U;
+		}
+		if (ret == DPS__SUCCEEDED)
+		{
+			ret = writeTempCorrection();
+		}
+		//single measurements cannot be resumed, their result is lost
+		m_opMode = IDLE;
+		if (ret == DPS__SUCCEEDED && (resumeMode & 0x04))
+		{
+			ret = setOpMode(resumeMode);
+		}
+		if (batch.end() != DPS__SUCCEEDED)
+		{
+			ret = DPS__FAIL_UNKNOWN;
+		}
+	}
+
+	m_recovering = 0U;
+	m_busFailures = 0U;
+	if (ret == DPS__SUCCEEDED)
+	{
+		m_recoveries++;
+	}
+	return ret;
+}
+
+uint16_t DpsClass::getRecoveryCount(void)
+{
+	return m_recoveries;
+}
+
+int16_t DpsClass::setTrim(const DpsTrim_t &trim)
+{
+	if (!(trim.prsGain > 0.0f && trim.prsGain <= DPS__TRIM_MAX_GAIN) ||
+		!(trim.prsTempCoeff >= -DPS__TRIM_MAX_TEMP_COEFF && trim.prsTempCoeff <= DPS__TRIM_MAX_TEMP_COEFF))
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	m_trim = trim;
+	//before begin() the coefficients are not known yet, readcoeffs() folds the trim again
+	foldTrim();
+	return DPS__SUCCEEDED;
+}
+
+void DpsClass::getTrim(DpsTrim_t &trim)
+{
+	trim = m_trim;
+}
+
+int16_t DpsClass::saveTrim(uint8_t *buffer, uint8_t length)
+{
+	if (buffer == NULL || length < DPS__TRIM_BLOB_LENGTH)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	dps::serializeTrim(m_trim, m_productID, m_revisionID, buffer);
+	return DPS__TRIM_BLOB_LENGTH;
+}
+
+int16_t DpsClass::loadTrim(const uint8_t *buffer, uint8_t length)
+{
+	DpsTrim_t trim;
+	uint8_t productId;
+	uint8_t revisionId;
+	if (buffer == NULL || length < DPS__TRIM_BLOB_LENGTH ||
+		dps::deserializeTrim(buffer, trim, productId, revisionId) != DPS__SUCCEEDED)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	//a trim is only valid for the kind of sensor it has been made for
+	if (productId != m_productID || revisionId != m_revisionID)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	return setTrim(trim);
+}
+
+void DpsClass::foldTrimInt(void)
+{
+	m_kInt.c00 = dps::floatToQ16(m_k.c00);
+	m_kInt.c10 = dps::floatToQ16(m_k.c10);
+	//the nonlinear terms with fewer fractional bits, so that they stay in 64 bits for all raw values
+	m_kInt.c01 = dps::floatToQ8(m_k.c01);
+	m_kInt.c11 = dps::floatToQ8(m_k.c11);
+	m_kInt.c20 = dps::floatToQ8(m_k.c20);
+	m_kInt.c21 = dps::floatToQ8(m_k.c21);
+	m_kInt.c30 = dps::floatToQ8(m_k.c30);
+	m_kInt.c02 = dps::floatToQ8(m_k.c02);
+	m_kInt.c12 = dps::floatToQ8(m_k.c12);
+	m_lastTempScalValid &= ~DPS__TEMP_SCAL_POLY;
+}
+
 int16_t DpsClass::getIntStatusFifoFull(void)
 {
-	return readByteBitfield(config_registers[INT_FLAG_FIFO]);
+	DPS_API_SCOPE(API_GET_INT_STATUS);
+	return readByteBitfield<INT_FLAG_FIFO>();
 }
 
 int16_t DpsClass::getIntStatusTempReady(void)
 {
-	return readByteBitfield(config_registers[INT_FLAG_TEMP]);
+	DPS_API_SCOPE(API_GET_INT_STATUS);
+	return readByteBitfield<INT_FLAG_TEMP>();
 }
 
 int16_t DpsClass::getIntStatusPrsReady(void)
 {
-	return readByteBitfield(config_registers[INT_FLAG_PRS]);
+	DPS_API_SCOPE(API_GET_INT_STATUS);
+	return readByteBitfield<INT_FLAG_PRS>();
 }
 
+const DpsFifoStats_t &DpsClass::getFifoStats(void) const
+{
+	return m_fifoStats;
+}
+
+DpsI2cMux *DpsClass::getMux(void) const
+{
+	return m_mux;
+}
+
+int8_t DpsClass::getMuxChannel(void) const
+{
+	return m_mux != NULL ? (int8_t)m_muxChannel : -1;
+}
+
+void DpsClass::resetFifoStats(void)
+{
+	memset(&m_fifoStats, 0, sizeof(m_fifoStats));
+}
+
+#ifdef DPS_ENABLE_BUS_STATS
+const BusStats_t &DpsClass::getBusStats(void) const
+{
+	return m_busStats;
+}
+
+void DpsClass::resetBusStats(void)
+{
+	memset(&m_busStats, 0, sizeof(m_busStats));
+}
+#endif
+
 //////// 	Declaration of private functions starts here	////////
 
+DpsClass::BusBatch::BusBatch(DpsClass &dps)
+	: m_transport(dps.m_SpiI2c == 2 ? dps.m_transport : NULL)
+{
+	if (m_transport != NULL)
+	{
+		m_transport->beginBatch();
+	}
+}
+
+DpsClass::BusBatch::~BusBatch(void)
+{
+	end();
+}
+
+int16_t DpsClass::BusBatch::end(void)
+{
+	if (m_transport == NULL)
+	{
+		return DPS__SUCCEEDED;
+	}
+	int16_t ret = m_transport->endBatch();
+	m_transport = NULL;
+	return ret;
+}
+
+int16_t DpsClass::recoverBus(void)
+{
+#ifndef DPS_DISABLESPI
+	if (m_SpiI2c == 0)
+	{
+		//an empty chip select frame resets the SPI interface of the sensor
+		digitalWrite(m_chipSelect, LOW);
+		digitalWrite(m_chipSelect, HIGH);
+		return DPS__SUCCEEDED;
+	}
+#endif
+	if (m_SpiI2c == 2)
+	{
+		return m_transport->recover();
+	}
+#if defined(DPS__I2C_SDA_PIN) && defined(DPS__I2C_SCL_PIN)
+	//bus clear: clock out a transfer the sensor is stuck in, then generate a stop condition
+	pinMode(DPS__I2C_SDA_PIN, INPUT_PULLUP);
+	pinMode(DPS__I2C_SCL_PIN, OUTPUT);
+	for (uint8_t i = 0; i < 9 && digitalRead(DPS__I2C_SDA_PIN) == LOW; i++)
+	{
+		digitalWrite(DPS__I2C_SCL_PIN, LOW);
+		delayMicroseconds(5);
+		digitalWrite(DPS__I2C_SCL_PIN, HIGH);
+		delayMicroseconds(5);
+	}
+	pinMode(DPS__I2C_SDA_PIN, OUTPUT);
+	digitalWrite(DPS__I2C_SDA_PIN, LOW);
+	delayMicroseconds(5);
+	digitalWrite(DPS__I2C_SDA_PIN, HIGH);
+	delayMicroseconds(5);
+#endif
+	//reinitialize the I2C controller
+	m_i2cbus->begin();
+	if (m_mux != NULL)
+	{
+		m_mux->invalidate();
+	}
+	return DPS__SUCCEEDED;
+}
+
+int16_t DpsClass::writeTempCorrection(void)
+{
+	if (writeByte(0x0E, 0xA5) || writeByte(0x0F, 0x96) || writeByte(0x62, 0x02) ||
+		writeByte(0x0E, 0x00) || writeByte(0x0F, 0x00))
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	return DPS__SUCCEEDED;
+}
+
+int16_t DpsClass::getSingleRawResult(int32_t &raw, Mode &mode)
+{
+	DPS_API_SCOPE(API_GET_SINGLE_RESULT);
+	//abort if initialization failed
+	if (m_initFail)
+	{
+		return DPS__FAIL_INIT_FAILED;
+	}
+
+	//read finished bit for current opMode
+	int16_t rdy;
+	switch (m_opMode)
+	{
+	case CMD_TEMP: //temperature
+		rdy = readByteBitfield<TEMP_RDY>();
+		break;
+	case CMD_PRS: //pressure
+		rdy = readByteBitfield<PRS_RDY>();
+		break;
+	default: //DPS310 not in command mode
+		return DPS__FAIL_TOOBUSY;
+	}
+	//read new measurement result
+	switch (rdy)
+	{
+	case DPS__FAIL_UNKNOWN: //could not read ready flag
+		return DPS__FAIL_UNKNOWN;
+	case 0: //ready flag not set, measurement still in progress
+		return DPS__FAIL_UNFINISHED;
+	case 1: //measurement ready, expected case
+		mode = m_opMode;
+		m_opMode = IDLE; //opcode was automatically reseted by DPS310
+		return getRawResult(&raw, registerBlocks[mode == CMD_TEMP ? TEMP : PRS]);
+	}
+	return DPS__FAIL_UNKNOWN;
+}
+
+int16_t DpsClass::getReadyRawResult(int32_t &raw, Mode &mode)
+{
+	DPS_API_SCOPE(API_GET_SINGLE_RESULT);
+	//abort if initialization failed
+	if (m_initFail)
+	{
+		return DPS__FAIL_INIT_FAILED;
+	}
+	if (m_opMode != CMD_TEMP && m_opMode != CMD_PRS)
+	{
+		return DPS__FAIL_TOOBUSY;
+	}
+
+	//results, ready flags and interrupt status in one transfer
+	uint8_t buffer[DPS__READY_BLOCK_LENGTH];
+	if (readBlock(readyBlock, buffer) != readyBlock.length)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	uint8_t measCfg = buffer[MSR_CTRL::regAddress - readyBlock.regAddress];
+	if (!(m_opMode == CMD_TEMP ? TEMP_RDY::decode(measCfg) : PRS_RDY::decode(measCfg)))
+	{
+		//measurement still in progress
+		return DPS__FAIL_UNFINISHED;
+	}
+	mode = m_opMode;
+	m_opMode = IDLE; //opcode was automatically reseted by the sensor
+
+	const uint8_t *result = buffer + registerBlocks[mode == CMD_TEMP ? TEMP : PRS].regAddress - readyBlock.regAddress;
+	raw = (uint32_t)result[0] << 16 | (uint32_t)result[1] << 8 | (uint32_t)result[2];
+	getTwosComplement(&raw, 24);
+	return DPS__SUCCEEDED;
+}
+
+int16_t DpsClass::measureRawOnce(int32_t &raw, Mode mode, uint8_t oversamplingRate)
+{
+	//Start measurement
+	int16_t ret = mode == CMD_TEMP ? startMeasureTempOnce(oversamplingRate) : startMeasurePressureOnce(oversamplingRate);
+	if (ret != DPS__SUCCEEDED)
+	{
+		return ret;
+	}
+
+	//wait until measurement is finished
+	delay(calcBusyTime(0U, mode == CMD_TEMP ? m_tempOsr : m_prsOsr) / DPS__BUSYTIME_SCALING);
+	delay(DPS310__BUSYTIME_FAILSAFE);
+
+	ret = getSingleRawResult(raw, mode);
+	if (ret != DPS__SUCCEEDED)
+	{
+		standby();
+	}
+	return ret;
+}
+
 int16_t DpsClass::setOpMode(uint8_t opMode)
 {
-	if (writeByteBitfield(opMode, config_registers[MSR_CTRL]) == -1)
+	//the sensor is idle if the driver has set the mode since begin() and no measurement is running
+	uint8_t knownIdle = m_opMode == IDLE && m_cfgInSync &&
+						(m_cfgShadowValid & (1U << (MSR_CTRL::regAddress - DPS__CFG_SHADOW_START)));
+	//all other bits of MEAS_CFG are read-only flags, so there is no need for a read-modify-write
+	if (!(opMode == IDLE && knownIdle) && writeByte(MSR_CTRL::regAddress, MSR_CTRL::encode(opMode)) == -1)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	//a paused measurement cannot be resumed after another one has been started
+	if (opMode != IDLE)
+	{
+		m_pausedMode = IDLE;
+	}
+	//the caller may wait for the measurement next, so nothing must be deferred
+	if (m_SpiI2c == 2 && m_transport->flush() != DPS__SUCCEEDED)
 	{
 		return DPS__FAIL_UNKNOWN;
 	}
 	m_opMode = (Mode)opMode;
+	//overrun estimation starts with the measurement
+	m_lastDrainTime = millis();
+	m_fifoLeft = 0U;
 	return DPS__SUCCEEDED;
 }
 
@@ -491,9 +987,8 @@ int16_t DpsClass::configTemp(uint8_t tempMr, uint8_t tempOsr)
 {
 	tempMr &= 0x07;
 	tempOsr &= 0x07;
-	// two accesses to the same register; for readability
-	int16_t ret = writeByteBitfield(tempMr, config_registers[TEMP_MR]);
-	ret = writeByteBitfield(tempOsr, config_registers[TEMP_OSR]);
+	// both fields are merged into a single access
+	int16_t ret = writeByteBitfield<TEMP_MR, TEMP_OSR>(tempMr, tempOsr);
 
 	//abort immediately on fail
 	if (ret != DPS__SUCCEEDED)
@@ -502,14 +997,14 @@ int16_t DpsClass::configTemp(uint8_t tempMr, uint8_t tempOsr)
 	}
 	m_tempMr = tempMr;
 	m_tempOsr = tempOsr;
+	return DPS__SUCCEEDED;
 }
 
 int16_t DpsClass::configPressure(uint8_t prsMr, uint8_t prsOsr)
 {
 	prsMr &= 0x07;
 	prsOsr &= 0x07;
-	int16_t ret = writeByteBitfield(prsMr, config_registers[PRS_MR]);
-	ret = writeByteBitfield(prsOsr, config_registers[PRS_OSR]);
+	int16_t ret = writeByteBitfield<PRS_MR, PRS_OSR>(prsMr, prsOsr);
 
 	//abort immediately on fail
 	if (ret != DPS__SUCCEEDED)
@@ -518,24 +1013,50 @@ int16_t DpsClass::configPressure(uint8_t prsMr, uint8_t prsOsr)
 	}
 	m_prsMr = prsMr;
 	m_prsOsr = prsOsr;
+	return DPS__SUCCEEDED;
 }
 
 int16_t DpsClass::enableFIFO()
 {
-	return writeByteBitfield(1U, config_registers[FIFO_EN]);
+	return writeByteBitfield<FIFO_EN>(1U);
 }
 
 int16_t DpsClass::disableFIFO()
 {
+	//the FIFO has been flushed when it was disabled and stays empty since
+	int16_t cfg = getCfgShadow(FIFO_EN::regAddress);
+	if (cfg >= 0 && !FIFO_EN::decode((uint8_t)cfg))
+	{
+		return DPS__SUCCEEDED;
+	}
 	int16_t ret = flushFIFO();
-	ret = writeByteBitfield(0U, config_registers[FIFO_EN]);
-	return ret;
+	if (ret < 0)
+	{
+		return ret;
+	}
+	return writeByteBitfield<FIFO_EN>(0U);
+}
+
+int16_t DpsClass::configBothCont(uint8_t tempCfg, uint8_t prsCfg, uint8_t /*tempShift*/, uint8_t /*prsShift*/)
+{
+	//no sensor specific bits known, keep them and do not shift the results
+	if (writeByteBitfield(tempCfg, TEMP_MR::regAddress, TEMP_MR::mask | TEMP_OSR::mask, 0U, 0U) ||
+		writeByteBitfield(prsCfg, PRS_MR::regAddress, PRS_MR::mask | PRS_OSR::mask, 0U, 0U))
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	return enableFIFO();
+}
+
+int16_t DpsClass::getFIFOFillLevel(void)
+{
+	//not reported by all sensors
+	return DPS__FAIL_UNKNOWN;
 }
 
 uint16_t DpsClass::calcBusyTime(uint16_t mr, uint16_t osr)
 {
-	//formula from datasheet (optimized)
-	return ((uint32_t)20U << mr) + ((uint32_t)16U << (osr + mr));
+	return dps::busyTime(mr, osr);
 }
 
 int16_t DpsClass::getFIFOvalue(int32_t *value)
@@ -552,14 +1073,36 @@ int16_t DpsClass::getFIFOvalue(int32_t *value)
 
 int16_t DpsClass::readByte(uint8_t regAddress)
 {
+	DPS_BUS_OP_START(start);
+	int16_t ret;
 	#ifndef DPS_DISABLESPI
 	//delegate to specialized function if Dps310 is connected via SPI
 	if (m_SpiI2c == 0)
 	{
-		return readByteSPI(regAddress);
+		ret = readByteSPI(regAddress);
 	}
+	else
 	#endif
+	if (m_SpiI2c == 2)
+	{
+		uint8_t data;
+		ret = m_transport->readBlock(regAddress, 1U, &data) == 1 ? data : DPS__FAIL_UNKNOWN;
+	}
+	else
+	{
+		ret = readByteI2C(regAddress);
+	}
+	DPS_BUS_OP_RECORD(BUS_OP_READ_BYTE, start, ret < 0 ? 0U : 1U, ret < 0);
+	trackBusAccess(ret < 0);
+	return ret;
+}
 
+int16_t DpsClass::readByteI2C(uint8_t regAddress)
+{
+	if (selectMuxChannel() != DPS__SUCCEEDED)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
 	m_i2cbus->beginTransmission(m_slaveAddress);
 	m_i2cbus->write(regAddress);
 	m_i2cbus->endTransmission(false);
@@ -574,6 +1117,15 @@ int16_t DpsClass::readByte(uint8_t regAddress)
 	}
 }
 
+int16_t DpsClass::selectMuxChannel(void)
+{
+	if (m_mux == NULL)
+	{
+		return DPS__SUCCEEDED;
+	}
+	return m_mux->select(m_muxChannel);
+}
+
 #ifndef DPS_DISABLESPI
 int16_t DpsClass::readByteSPI(uint8_t regAddress)
 {
@@ -649,13 +1201,55 @@ int16_t DpsClass::writeByte(uint8_t regAddress, uint8_t data)
 
 int16_t DpsClass::writeByte(uint8_t regAddress, uint8_t data, uint8_t check)
 {
+	DPS_BUS_OP_START(start);
+	int16_t ret;
 	#ifndef DPS_DISABLESPI
 	//delegate to specialized function if Dps310 is connected via SPI
 	if (m_SpiI2c == 0)
 	{
-		return writeByteSpi(regAddress, data, check);
+		//the check is done below for both buses
+		ret = writeByteSpi(regAddress, data, 0U);
 	}
+	else
 	#endif
+	if (m_SpiI2c == 2)
+	{
+		ret = m_transport->writeByte(regAddress, data);
+	}
+	else
+	{
+		ret = writeByteI2C(regAddress, data);
+	}
+	DPS_BUS_OP_RECORD(BUS_OP_WRITE_BYTE, start, ret < 0 ? 0U : 1U, ret < 0);
+	trackBusAccess(ret < 0);
+	//remember the configuration for recover()
+	uint8_t shadowIndex = regAddress - DPS__CFG_SHADOW_START;
+	if (ret == DPS__SUCCEEDED && shadowIndex < DPS__CFG_SHADOW_LENGTH)
+	{
+		m_cfgShadow[shadowIndex] = data;
+		m_cfgShadowValid |= 1U << shadowIndex;
+	}
+
+	if (ret != DPS__SUCCEEDED || check == 0)
+	{
+		return ret; //no checking
+	}
+	if (readByte(regAddress) == data) //check if desired by calling function
+	{
+		return DPS__SUCCEEDED;
+	}
+	else
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+}
+
+int16_t DpsClass::writeByteI2C(uint8_t regAddress, uint8_t data)
+{
+	if (selectMuxChannel() != DPS__SUCCEEDED)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
 	m_i2cbus->beginTransmission(m_slaveAddress);
 	m_i2cbus->write(regAddress);		  //Write Register number to buffer
 	m_i2cbus->write(data);				  //Write data to buffer
@@ -663,19 +1257,7 @@ int16_t DpsClass::writeByte(uint8_t regAddress, uint8_t data, uint8_t check)
 	{
 		return DPS__FAIL_UNKNOWN;
 	}
-	else
-	{
-		if (check == 0)
-			return 0;					  //no checking
-		if (readByte(regAddress) == data) //check if desired by calling function
-		{
-			return DPS__SUCCEEDED;
-		}
-		else
-		{
-			return DPS__FAIL_UNKNOWN;
-		}
-	}
+	return DPS__SUCCEEDED;
 }
 
 #ifndef DPS_DISABLESPI
@@ -730,19 +1312,38 @@ int16_t DpsClass::writeByteBitfield(uint8_t data, RegMask_t regMask)
 	return writeByteBitfield(data, regMask.regAddress, regMask.mask, regMask.shift, 0U);
 }
 
+int16_t DpsClass::getCfgShadow(uint8_t regAddress)
+{
+	uint8_t shadowIndex = regAddress - DPS__CFG_SHADOW_START;
+	if (!m_cfgInSync || shadowIndex >= DPS__CFG_SHADOW_LENGTH || regAddress == MSR_CTRL::regAddress ||
+		!(m_cfgShadowValid & (1U << shadowIndex)))
+	{
+		return -1;
+	}
+	return m_cfgShadow[shadowIndex];
+}
+
 int16_t DpsClass::writeByteBitfield(uint8_t data,
 									uint8_t regAddress,
 									uint8_t mask,
 									uint8_t shift,
 									uint8_t check)
 {
-	int16_t old = readByte(regAddress);
-	if (old < 0)
+	int16_t cached = getCfgShadow(regAddress);
+	//nothing to do if the register already has the new content
+	if (cached >= 0 && (((uint8_t)cached & ~mask) | ((data << shift) & mask)) == (uint8_t)cached)
 	{
-		//fail while reading
-		return old;
+		return DPS__SUCCEEDED;
 	}
-	return writeByte(regAddress, ((uint8_t)old & ~mask) | ((data << shift) & mask), check);
+	DPS_BUS_OP_START(start);
+	int16_t ret = cached >= 0 ? cached : readByte(regAddress);
+	//abort on fail while reading
+	if (ret >= 0)
+	{
+		ret = writeByte(regAddress, ((uint8_t)ret & ~mask) | ((data << shift) & mask), check);
+	}
+	DPS_BUS_OP_RECORD(BUS_OP_WRITE_BITFIELD, start, ret < 0 ? 0U : 1U, ret < 0);
+	return ret;
 }
 
 int16_t DpsClass::readByteBitfield(RegMask_t regMask)
@@ -757,18 +1358,41 @@ int16_t DpsClass::readByteBitfield(RegMask_t regMask)
 
 int16_t DpsClass::readBlock(RegBlock_t regBlock, uint8_t *buffer)
 {
+	DPS_BUS_OP_START(start);
+	int16_t ret;
 	#ifndef DPS_DISABLESPI
 	//delegate to specialized function if Dps310 is connected via SPI
 	if (m_SpiI2c == 0)
 	{
-		return readBlockSPI(regBlock, buffer);
+		ret = readBlockSPI(regBlock, buffer);
 	}
+	else
 	#endif
+	if (m_SpiI2c == 2)
+	{
+		//do not read if there is no buffer
+		ret = buffer == NULL ? 0 : m_transport->readBlock(regBlock.regAddress, regBlock.length, buffer);
+	}
+	else
+	{
+		ret = readBlockI2C(regBlock, buffer);
+	}
+	DPS_BUS_OP_RECORD(BUS_OP_READ_BLOCK, start, ret < 0 ? 0U : (uint16_t)ret, ret != regBlock.length);
+	trackBusAccess(ret != regBlock.length);
+	return ret;
+}
+
+int16_t DpsClass::readBlockI2C(RegBlock_t regBlock, uint8_t *buffer)
+{
 	//do not read if there is no buffer
 	if (buffer == NULL)
 	{
 		return 0; //0 bytes read successfully
 	}
+	if (selectMuxChannel() != DPS__SUCCEEDED)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
 
 	m_i2cbus->beginTransmission(m_slaveAddress);
 	m_i2cbus->write(regBlock.regAddress);
@@ -19,8 +19,39 @@
 #endif
 #include <Wire.h>
 #include "util/dps_config.h"
+#include "util/DpsBusStats.h"
+#include "util/DpsMeasurementConfig.h"
+#include "DpsI2cMux.h"
+#include "DpsTransport.h"
+#include "DpsTrim.h"
 #include <Arduino.h>
 
+/**
+ * @brief FIFO counters of a sensor, see DpsClass::getFifoStats()
+ */
+typedef struct
+{
+	uint32_t delivered; //results written to the buffers of getContResults
+	uint32_t dropped;	//results read from the FIFO without a buffer to write them to
+	uint32_t overruns;	//drains that found the FIFO full, so newer results were lost
+	uint32_t lost;		//results lost to overruns, a rough estimate from the measure rates and the time between drains;
+						//may be too high by up to DPS__FIFO_SIZE per overrun if a drain left results of unknown number
+} DpsFifoStats_t;
+
+/**
+ * @brief one result of a continuous measurement, as handed to the handler of getContSamples
+ *
+ * @tparam Result 	float (°C, Pa) or int32_t (0.001 °C, 0.01 Pa)
+ */
+template <class Result>
+struct DpsResult
+{
+	uint8_t type;			 //dps::SampleType_e
+	int32_t raw;			 //raw value from the FIFO, its LSB is the type
+	Result value;			 //compensated value
+	unsigned long timestamp; //millis() of the measurement, estimated from the measure rate
+};
+
 class DpsClass
 {
   public:
@@ -42,6 +73,15 @@ class DpsClass
 	 */
 	void begin(TwoWire &bus, uint8_t slaveAddress);
 
+	/**
+	 * I2C begin function for a sensor behind a multiplexer
+	 *
+	 * @param &mux: 			multiplexer which connects the sensor to its bus
+	 * @param channel: 		channel of the multiplexer the sensor is connected to
+	 * @param slaveAddress: 	I2C address of the sensor (0x77 or 0x76)
+	 */
+	void begin(DpsI2cMux &mux, uint8_t channel, uint8_t slaveAddress);
+
 #ifndef DPS_DISABLESPI
 	/**
 	 * SPI begin function for Dps310 with 4-wire SPI
@@ -61,6 +101,14 @@ class DpsClass
 	void begin(SPIClass &bus, int32_t chipSelect, uint8_t threeWire);
 #endif
 
+	/**
+	 * begin function for buses that are not covered by TwoWire and SPIClass,
+	 * e.g. Linux i2c-dev or spidev backends
+	 *
+	 * @param &transport: 		bus backend which connects the host to the sensor
+	 */
+	void begin(DpsTransport &transport);
+
 	/**
 	 * End function for Dps310
 	 * Sets the sensor to idle mode
@@ -84,6 +132,22 @@ class DpsClass
 	 */
 	int16_t standby(void);
 
+	/**
+	 * Stops a continuous measurement, but keeps its configuration and the result FIFO enabled,
+	 * so that resume() can restart it with a single register write.
+	 * Results that have not been read yet are flushed.
+	 *
+	 * @return		status code, DPS__FAIL_TOOBUSY if no continuous measurement is running
+	 */
+	int16_t pause(void);
+
+	/**
+	 * restarts the continuous measurement stopped by pause()
+	 *
+	 * @return		status code, DPS__FAIL_TOOBUSY if there is no paused measurement
+	 */
+	int16_t resume(void);
+
 	/**
 	 * performs one temperature measurement
 	 *
@@ -102,6 +166,23 @@ class DpsClass
 	 */
 	int16_t measureTempOnce(float &result, uint8_t oversamplingRate);
 
+	/**
+	 * performs one temperature measurement without float arithmetic
+	 *
+	 * @param &result:		reference to an integer where the result in 0.001 °C will be written
+	 * @return 	status code
+	 */
+	int16_t measureTempOnce(int32_t &result);
+
+	/**
+	 * performs one temperature measurement with specified oversamplingRate without float arithmetic
+	 *
+	 * @param &result:				reference to an integer where the result in 0.001 °C will be written
+	 * @param oversamplingRate: 	DPS__OVERSAMPLING_RATE_1, DPS__OVERSAMPLING_RATE_2, DPS__OVERSAMPLING_RATE_4 ... DPS__OVERSAMPLING_RATE_128
+	 * @return 			status code
+	 */
+	int16_t measureTempOnce(int32_t &result, uint8_t oversamplingRate);
+
 	/**
 	 * starts a single temperature measurement
 	 *
@@ -134,6 +215,23 @@ class DpsClass
 	 */
 	int16_t measurePressureOnce(float &result, uint8_t oversamplingRate);
 
+	/**
+	 * performs one pressure measurement without float arithmetic
+	 *
+	 * @param &result:		reference to an integer where the result in 0.01 Pa will be written
+	 * @return 	status code
+	 */
+	int16_t measurePressureOnce(int32_t &result);
+
+	/**
+	 * performs one pressure measurement with specified oversamplingRate without float arithmetic
+	 *
+	 * @param &result:				reference to an integer where the result in 0.01 Pa will be written
+	 * @param oversamplingRate: 	DPS__OVERSAMPLING_RATE_1, DPS__OVERSAMPLING_RATE_2, DPS__OVERSAMPLING_RATE_4 ... DPS__OVERSAMPLING_RATE_128
+	 * @return 			status code
+	 */
+	int16_t measurePressureOnce(int32_t &result, uint8_t oversamplingRate);
+
 	/**
 	 * starts a single pressure measurement
 	 *
@@ -157,6 +255,34 @@ class DpsClass
 	 */
 	int16_t getSingleResult(float &result);
 
+	/**
+	 * gets the result a single temperature or pressure measurement without float arithmetic
+	 *
+	 * @param &result:		reference to an integer where the result in 0.001 °C or 0.01 Pa will be written
+	 * @return 	status code
+	 */
+	int16_t getSingleResult(int32_t &result);
+
+	/**
+	 * completes a single temperature or pressure measurement after its ready interrupt.
+	 * Results, ready flags and interrupt status are read in one burst, which also clears the interrupt.
+	 * The ready interrupts have to be enabled with enableReadyInterrupts() before the measurement is started
+	 * with startMeasureTempOnce() or startMeasurePressureOnce().
+	 * Like the interrupt handling of continuous measurements, this must not be called from the interrupt handler.
+	 *
+	 * @param &result:		reference to a float value where the result in °C or Pa will be written
+	 * @return 	status code, DPS__FAIL_UNFINISHED if the measurement has not finished yet (e.g. after a spurious edge)
+	 */
+	int16_t getReadyResult(float &result);
+
+	/**
+	 * like getReadyResult(float &), without float arithmetic
+	 *
+	 * @param &result:		reference to an integer where the result in 0.001 °C or 0.01 Pa will be written
+	 * @return 	status code
+	 */
+	int16_t getReadyResult(int32_t &result);
+
 	/**
 	 * starts a continuous temperature measurement with specified measurement rate and oversampling rate
 	 * If measure rate is n and oversampling rate is m, the DPS310 performs 2^(n+m) internal measurements per second. 
@@ -190,6 +316,58 @@ class DpsClass
 	 */
 	int16_t startMeasureBothCont(uint8_t tempMr, uint8_t tempOsr, uint8_t prsMr, uint8_t prsOsr);
 
+	/**
+	 * starts a continuous temperature and pressure measurement with a configuration fixed at compile time.
+	 * The configuration is validated by the compiler and the register contents are precomputed,
+	 * so no validation is done at runtime.
+	 *
+	 * @tparam Config		configuration as DpsMeasurementConfig<tempMr, tempOsr, prsMr, prsOsr>
+	 * @return 			status code
+	 */
+	template <class Config>
+	int16_t startMeasureBothCont(void)
+	{
+		DPS_API_SCOPE(dps::API_START_MEASURE_BOTH_CONT);
+		//abort if initialization failed
+		if (m_initFail)
+		{
+			return DPS__FAIL_INIT_FAILED;
+		}
+		//abort if device is not in idling mode
+		if (m_opMode != dps::IDLE)
+		{
+			return DPS__FAIL_TOOBUSY;
+		}
+		BusBatch batch(*this);
+		//write precomputed configuration and enable result FIFO
+		if (configBothCont(Config::tempCfg, Config::prsCfg, Config::tempShift, Config::prsShift))
+		{
+			return DPS__FAIL_UNKNOWN;
+		}
+		m_tempMr = Config::tempMr;
+		m_tempOsr = Config::tempOsr;
+		m_prsMr = Config::prsMr;
+		m_prsOsr = Config::prsOsr;
+		//Start measuring in background mode
+		if (setOpMode(dps::CONT_BOTH))
+		{
+			return DPS__FAIL_UNKNOWN;
+		}
+		return DPS__SUCCEEDED;
+	}
+
+	/**
+	 * compensates a raw result of getContRawResults.
+	 * Pressures use the temperature compensated last, so the results have to be compensated in FIFO order.
+	 *
+	 * @param raw: 	raw value, the LSB marks whether it is a temperature (0) or a pressure (1)
+	 * @return 	temperature in °C or pressure in Pa
+	 */
+	float compensate(int32_t raw)
+	{
+		return (raw & 0x01) ? calcPressure(raw) : calcTemp(raw);
+	}
+
 	/**
 	 * Gets the interrupt status flag of the FIFO
 	 *
@@ -224,6 +402,90 @@ class DpsClass
 	 */
 	int16_t correctTemp(void);
 
+	/**
+	 * Brings the sensor back after bus faults, without the delay and coefficient reload of begin():
+	 * resets the bus interface and the sensor, restores the configuration that was written before
+	 * and resumes a continuous measurement. The outage is at most a few tens of ms.
+	 * Results in the FIFO and a running single measurement are lost.
+	 * getContResults calls this itself after DPS__RECOVERY_THRESHOLD failed bus accesses in a row.
+	 *
+	 * @return 	status code
+	 */
+	int16_t recover(void);
+
+	/**
+	 * @return 	number of successful recoveries since begin()
+	 */
+	uint16_t getRecoveryCount(void);
+
+	/**
+	 * sets the calibration trim of this sensor (see DpsTrim.h) and folds it into the compensation coefficients,
+	 * so that trimmed results cost no more than untrimmed ones
+	 *
+	 * @param &trim: 	the trim; prsGain has to be positive
+	 * @return 	status code
+	 */
+	int16_t setTrim(const DpsTrim_t &trim);
+
+	/**
+	 * @param &trim: 	the trim that is applied
+	 */
+	void getTrim(DpsTrim_t &trim);
+
+	/**
+	 * serializes the trim together with the product and revision ID of the sensor, e.g. for an EEPROM
+	 *
+	 * @param *buffer: 	buffer for the serialized trim
+	 * @param length: 	size of the buffer, at least DPS__TRIM_BLOB_LENGTH
+	 * @return 	number of bytes written or -1 if the buffer is too small
+	 */
+	int16_t saveTrim(uint8_t *buffer, uint8_t length);
+
+	/**
+	 * applies a trim serialized by saveTrim, if it belongs to a sensor with the same product and revision ID
+	 *
+	 * @param *buffer: 	the serialized trim
+	 * @param length: 	number of bytes in the buffer
+	 * @return 	status code, DPS__FAIL_UNKNOWN if the trim is damaged or belongs to another kind of sensor
+	 */
+	int16_t loadTrim(const uint8_t *buffer, uint8_t length);
+
+	/**
+	 * returns the FIFO counters collected since begin() or the last resetFifoStats(),
+	 * e.g. to choose buffer sizes and drain intervals
+	 */
+	const DpsFifoStats_t &getFifoStats(void) const;
+
+	/**
+	 * returns the multiplexer the sensor is connected through, e.g. to group sensors by channel
+	 *
+	 * @return 	the multiplexer, NULL if the sensor is not connected through one
+	 */
+	DpsI2cMux *getMux(void) const;
+
+	/**
+	 * @return 	multiplexer channel of the sensor, -1 if it is not connected through a multiplexer
+	 */
+	int8_t getMuxChannel(void) const;
+
+	/**
+	 * clears all FIFO counters
+	 */
+	void resetFifoStats(void);
+
+#ifdef DPS_ENABLE_BUS_STATS
+	/**
+	 * returns the bus statistics collected since begin() or the last resetBusStats()
+	 * only available if DPS_ENABLE_BUS_STATS is defined
+	 */
+	const dps::BusStats_t &getBusStats(void) const;
+
+	/**
+	 * clears all bus statistics
+	 */
+	void resetBusStats(void);
+#endif
+
   protected:
 	//scaling factor table
 	static const int32_t scaling_facts[DPS__NUM_OF_SCAL_FACTS];
@@ -251,15 +513,70 @@ class DpsClass
 	int32_t m_c21;
 	int32_t m_c30;
 
+	/**
+	 * @brief compensation coefficients with the user trim folded in, see setTrim()
+	 * The temperature is t0 + t1 * scaled raw value for the DPS310 and t0 + t1 * u for the DPS422;
+	 * c02 and c12 are only used by the DPS422.
+	 */
+	struct TrimmedCoeffs
+	{
+		float t0;
+		float t1;
+		float c00;
+		float c10;
+		float c01;
+		float c11;
+		float c20;
+		float c21;
+		float c30;
+		float c02;
+		float c12;
+	};
+
+	/**
+	 * @brief the same for the integer compensation: t0 in 0.001 °C, c00 and c10 as Q16 numbers,
+	 * the coefficients of the nonlinear terms as Q8 numbers (see DpsFixedPoint.h for the bounds)
+	 */
+	struct TrimmedCoeffsInt
+	{
+		int32_t t0;
+		int64_t c00;
+		int64_t c10;
+		int64_t c01;
+		int64_t c11;
+		int64_t c20;
+		int64_t c21;
+		int64_t c30;
+		int64_t c02;
+		int64_t c12;
+	};
+
+	DpsTrim_t m_trim;
+	TrimmedCoeffs m_k;
+	TrimmedCoeffsInt m_kInt;
+
 	// last measured scaled temperature (necessary for pressure compensation)
 	float m_lastTempScal;
+	// the same as Q24 number, for the integer compensation
+	int32_t m_lastTempScalQ24;
+	// raw value and oversampling rate of the last temperature, so that the float and the integer
+	// compensation can calculate their form of the scaled temperature when the other one measured it
+	int32_t m_lastTempRaw;
+	uint8_t m_lastTempOsr;
+	uint8_t m_lastTempScalValid; //DPS__TEMP_SCAL_FLOAT, DPS__TEMP_SCAL_Q24 and/or DPS__TEMP_SCAL_POLY
+	// pressure as cubic polynomial in the raw value, with the last temperature and 1 / scaling factor folded in;
+	// calculated by calcTemp, so that calcPressure only needs three multiplications per result
+	float m_prsPoly[4];
+	uint8_t m_prsPolyOsr; //pressure oversampling rate m_prsPoly has been calculated for
 
 	//bus specific
-	uint8_t m_SpiI2c; //0=SPI, 1=I2C
+	uint8_t m_SpiI2c; //0=SPI, 1=I2C, 2=DpsTransport
 
 	//used for I2C
 	TwoWire *m_i2cbus;
 	uint8_t m_slaveAddress;
+	DpsI2cMux *m_mux; //NULL if the sensor is connected directly
+	uint8_t m_muxChannel;
 
 #ifndef DPS_DISABLESPI
 	//used for SPI
@@ -267,6 +584,50 @@ class DpsClass
 	int32_t m_chipSelect;
 	uint8_t m_threeWire;
 #endif
+
+	//used for other buses
+	DpsTransport *m_transport;
+
+	//bus fault handling
+	uint8_t m_busFailures; //failed bus accesses in a row
+	uint8_t m_recovering;
+	uint16_t m_recoveries;
+	//last values written to the configuration registers, restored by recover()
+	uint8_t m_cfgShadow[DPS__CFG_SHADOW_LENGTH];
+	uint8_t m_cfgShadowValid; //bit i is set if m_cfgShadow[i] has been written
+	uint8_t m_cfgInSync; //0 from a soft reset until recover() has restored m_cfgShadow to the sensor
+	//continuous mode stopped by pause(), IDLE if there is none
+	dps::Mode m_pausedMode;
+
+	//FIFO accounting
+	DpsFifoStats_t m_fifoStats;
+	unsigned long m_lastDrainTime; //millis() of the last drain or the start of the continuous measurement
+	uint8_t m_fifoLeft;			   //results the last drain left in the FIFO because the buffers were full
+
+	/**
+	 * @brief marks a register sequence as batch while the object lives (see DpsTransport::beginBatch)
+	 * Has no effect on TwoWire and SPIClass.
+	 */
+	class BusBatch
+	{
+	  public:
+		explicit BusBatch(DpsClass &dps);
+		~BusBatch(void);
+
+		/**
+		 * ends the batch before the object is destroyed
+		 *
+		 * @return 	0 if all deferred writes were sent successfully, -1 on fail
+		 */
+		int16_t end(void);
+
+	  private:
+		DpsTransport *m_transport;
+	};
+
+#ifdef DPS_ENABLE_BUS_STATS
+	dps::BusStats_t m_busStats;
+#endif
 	/**
 	 * Initializes the sensor.
 	 * This function has to be called from begin()
@@ -275,15 +636,29 @@ class DpsClass
 	virtual void init(void) = 0;
 
 	/**
-	 * reads the compensation coefficients from the sensor
+	 * decodes the compensation coefficients from the registers init() has read
 	 * this is called once from init(), which is called from begin()
 	 *
+	 * @param *snapshot: 	content of the init block of the sensor (see initBlock in the chip config)
 	 * @return 	0 on success, -1 on fail
 	 */
-	virtual int16_t readcoeffs(void) = 0;
+	virtual int16_t readcoeffs(const uint8_t *snapshot) = 0;
+
+	/**
+	 * calculates m_k and m_kInt from the coefficients of the sensor and m_trim;
+	 * called at the end of readcoeffs() and by setTrim()
+	 */
+	virtual void foldTrim(void) = 0;
+
+	/**
+	 * converts the pressure coefficients of m_k to m_kInt; m_prsPoly has to be calculated again afterwards
+	 */
+	void foldTrimInt(void);
 
 	/**
 	 * Sets the Operation Mode of the sensor
+	 * Deferred writes of a batch are sent together with it, so measurements start immediately.
+	 * Switching to IDLE is skipped if the sensor is known to be idle already.
 	 * 
 	 * @param opMode: 			the new OpMode as defined by dps::Mode; CMD_BOTH should not be used for DPS310
 	 * @return 			0 on success, -1 on fail
@@ -309,12 +684,142 @@ class DpsClass
 	 */
 	virtual int16_t configPressure(uint8_t prs_mr, uint8_t prs_osr);
 
+	/**
+	 * Writes a complete, precomputed configuration for continuous measurement of temperature and pressure
+	 * and enables the result FIFO; used by startMeasureBothCont<Config>().
+	 * The sensor specific bits of the configuration registers are added by the derived classes.
+	 *
+	 * @param tempCfg: 	measure rate and oversampling rate fields of TEMP_CFG
+	 * @param prsCfg: 	measure rate and oversampling rate fields of PRS_CFG
+	 * @param tempShift: 	1 if the temperature result needs to be shifted (oversampling rate above 8)
+	 * @param prsShift: 	1 if the pressure result needs to be shifted (oversampling rate above 8)
+	 * @return 	0 normally or -1 on fail
+	 */
+	virtual int16_t configBothCont(uint8_t tempCfg, uint8_t prsCfg, uint8_t tempShift, uint8_t prsShift);
+
 	virtual int16_t flushFIFO() = 0;
 
+	/**
+	 * starts a soft reset of the sensor
+	 *
+	 * @return 	0 on success, -1 on fail
+	 */
+	virtual int16_t softReset(void) = 0;
+
+	/**
+	 * checks if the sensor has finished its initialization after power-on or soft reset
+	 *
+	 * @return 	1 if ready, 0 if not, -1 on fail
+	 */
+	virtual int16_t getSensorReady(void) = 0;
+
+	/**
+	 * sets up the I2C connection and initializes the sensor; common part of the I2C begin functions
+	 */
+	void beginI2C(TwoWire &bus, uint8_t slaveAddress);
+
+	/**
+	 * brings the bus to a defined state: I2C bus clear, SPI resync or DpsTransport::recover()
+	 *
+	 * @return 	0 on success, -1 on fail
+	 */
+	int16_t recoverBus(void);
+
+	/**
+	 * writes the register sequence of correctTemp()
+	 */
+	int16_t writeTempCorrection(void);
+
+	/**
+	 * counts failed bus accesses in a row; used to detect a bus or sensor that needs recover()
+	 *
+	 * @param failed: 	1 if the access failed, 0 if it succeeded
+	 */
+	void trackBusAccess(uint8_t failed)
+	{
+		if (!failed)
+		{
+			m_busFailures = 0U;
+		}
+		else if (m_busFailures < 0xFFU)
+		{
+			m_busFailures++;
+		}
+	}
+
+	/**
+	 * reads the number of results in the FIFO, if the sensor reports it
+	 *
+	 * @return 	number of results, -1 if unknown or on fail
+	 */
+	virtual int16_t getFIFOFillLevel(void);
+
 	virtual float calcTemp(int32_t raw) = 0;
 
 	virtual float calcPressure(int32_t raw) = 0;
 
+	/**
+	 * compensates a raw temperature without float arithmetic
+	 *
+	 * @return 	temperature in 0.001 °C (DPS__INT_TEMP_SCALE)
+	 */
+	virtual int32_t calcTempInt(int32_t raw) = 0;
+
+	/**
+	 * compensates a raw pressure without float arithmetic
+	 *
+	 * @return 	pressure in 0.01 Pa (DPS__INT_PRS_SCALE)
+	 */
+	virtual int32_t calcPressureInt(int32_t raw) = 0;
+
+	/**
+	 * @brief integer compensation of the sensor for drainFIFO
+	 */
+	struct IntCompensation
+	{
+		explicit IntCompensation(DpsClass &dps) : m_dps(dps) {}
+
+		int32_t calcTemp(int32_t raw)
+		{
+			return m_dps.calcTempInt(raw);
+		}
+
+		int32_t calcPressure(int32_t raw)
+		{
+			return m_dps.calcPressureInt(raw);
+		}
+
+		DpsClass &m_dps;
+	};
+
+	/**
+	 * reads the result of a finished single measurement
+	 *
+	 * @param &raw: 	raw result
+	 * @param &mode: 	CMD_TEMP or CMD_PRS, the type of the result
+	 * @return 	status code
+	 */
+	int16_t getSingleRawResult(int32_t &raw, dps::Mode &mode);
+
+	/**
+	 * reads the result of a finished single measurement and clears the ready interrupt, see getReadyResult
+	 *
+	 * @param &raw: 	raw result
+	 * @param &mode: 	the measurement the result belongs to, CMD_TEMP or CMD_PRS
+	 * @return 	status code
+	 */
+	int16_t getReadyRawResult(int32_t &raw, dps::Mode &mode);
+
+	/**
+	 * performs one temperature or pressure measurement and reads the raw result
+	 *
+	 * @param &raw: 	raw result
+	 * @param mode: 	CMD_TEMP or CMD_PRS
+	 * @param oversamplingRate: 	oversampling rate of the measurement
+	 * @return 	status code
+	 */
+	int16_t measureRawOnce(int32_t &raw, dps::Mode mode, uint8_t oversamplingRate);
+
 	int16_t enableFIFO();
 
 	int16_t disableFIFO();
@@ -341,21 +846,257 @@ class DpsClass
 	 */
 	int16_t getFIFOvalue(int32_t *value);
 
+	/**
+	 * reads the next raw values from the FIFO
+	 * On buses connected by a DpsTransport up to maxCount values are read in one batch,
+	 * otherwise one value is read after checking the FIFO empty flag.
+	 * The LSB of each value marks whether it is a temperature (0) or a pressure (1).
+	 *
+	 * @tparam FifoEmpty 	The FIFO empty register field of the sensor
+	 * @param raw: 		buffer for the raw values
+	 * @param maxCount: 	size of the buffer, at most DPS__FIFO_BATCH
+	 * @return	number of values read without empty markers, 0 if the FIFO is empty, -1 on fail
+	 */
+	template <class FifoEmpty>
+	int16_t getFIFOvalues(int32_t *raw, uint8_t maxCount);
+
 	/**
 	 * Gets the results from continuous measurements and writes them to given arrays
+	 * Reading stops as soon as one of the buffers is full; the remaining results stay in the FIFO
+	 * for the next call. Since the FIFO does not tell the type of the next result in advance,
+	 * this already happens when one buffer is full, as long as its type is measured.
 	 *
 	 * @param *tempBuffer: 	The start address of the buffer where the temperature results are written
-	 * 					If this is NULL, no temperature results will be written out
+	 * 					If this is NULL, temperature results are read and dropped
 	 * @param &tempCount:		The size of the buffer for temperature results.
-	 * 					When the function ends, it will contain the number of bytes written to the buffer.
+	 * 					When the function ends, it will contain the number of results written to the buffer.
 	 * @param *prsBuffer: 		The start address of the buffer where the pressure results are written
-	 * 					If this is NULL, no pressure results will be written out
+	 * 					If this is NULL, pressure results are read and dropped
 	 * @param &prsCount:		The size of the buffer for pressure results.
-	 * 					When the function ends, it will contain the number of bytes written to the buffer.
-	 * @param reg The FIFO empty register field; needed since this field is different for each sensor
+	 * 					When the function ends, it will contain the number of results written to the buffer.
+	 * @tparam FifoEmpty The FIFO empty register field; needed since this field is different for each sensor
+	 * @tparam FifoFull The FIFO full register field
 	 * @return			status code
 	 */
-	int16_t getContResults(float *tempBuffer, uint8_t &tempCount, float *prsBuffer, uint8_t &prsCount, RegMask_t reg);
+	template <class FifoEmpty, class FifoFull>
+	int16_t getContResults(float *tempBuffer, uint8_t &tempCount, float *prsBuffer, uint8_t &prsCount)
+	{
+		return drainFIFO<FifoEmpty, FifoFull>(*this, tempBuffer, tempCount, prsBuffer, prsCount);
+	}
+
+	/**
+	 * Gets the results from continuous measurements as integers, in 0.001 °C and 0.01 Pa,
+	 * without float arithmetic; otherwise like getContResults with float buffers
+	 */
+	template <class FifoEmpty, class FifoFull>
+	int16_t getContResults(int32_t *tempBuffer, uint8_t &tempCount, int32_t *prsBuffer, uint8_t &prsCount)
+	{
+		IntCompensation comp(*this);
+		return drainFIFO<FifoEmpty, FifoFull>(comp, tempBuffer, tempCount, prsBuffer, prsCount);
+	}
+
+	/**
+	 * Gets the raw results from continuous measurements in the order of the FIFO, without compensation;
+	 * the LSB of each value marks whether it is a temperature (0) or a pressure (1).
+	 * Use compensate() to convert them later, e.g. a whole block at once.
+	 *
+	 * @param *raw: 		buffer for the raw values; with NULL nothing is read
+	 * @param &count: 	size of the buffer; when the function ends, the number of values written to it
+	 * @tparam FifoEmpty The FIFO empty register field
+	 * @tparam FifoFull The FIFO full register field
+	 * @return			status code
+	 */
+	template <class FifoEmpty, class FifoFull>
+	int16_t getContRawResults(int32_t *raw, uint8_t &count)
+	{
+		RawSink sink(raw, count);
+		int16_t ret = drainFIFO<FifoEmpty, FifoFull>(sink);
+		count = sink.m_count;
+		return ret;
+	}
+
+	/**
+	 * Hands each result of a continuous measurement to a handler, right when it has been read and compensated,
+	 * so filters or loggers can work on it without a result buffer and a second loop.
+	 * The results are handed over in FIFO order until the FIFO is empty.
+	 *
+	 * The FIFO does not store times. The results read by the last drain were measured before it,
+	 * so the timestamp of the n-th result of a type is the time of the last drain plus n measurement periods,
+	 * at most the time of this drain. This is exact to about one period as long as the FIFO does not overflow.
+	 *
+	 * @param &comp: 		object providing Result calcTemp(int32_t) and Result calcPressure(int32_t)
+	 * @param &handler: 	function, lambda or object with operator(), called as handler(const DpsResult<Result> &)
+	 * @tparam FifoEmpty The FIFO empty register field
+	 * @tparam FifoFull The FIFO full register field
+	 * @return			status code
+	 */
+	template <class FifoEmpty, class FifoFull, class Result, class Compensation, class Handler>
+	int16_t getContSamples(Compensation &comp, Handler &handler)
+	{
+		SampleSink<Compensation, Result, Handler> sink(*this, comp, handler);
+		return drainFIFO<FifoEmpty, FifoFull>(sink);
+	}
+
+	/**
+	 * The FIFO drain loop behind getContResults, for result buffers of each type.
+	 * It is a template so that the compensation can be bound at compile time:
+	 * getContResults passes the sensor itself (virtual calcTemp/calcPressure),
+	 * DpsSensor passes an object with statically bound, inlinable compensation.
+	 *
+	 * @param &comp: 		object providing Result calcTemp(int32_t) and Result calcPressure(int32_t)
+	 * @tparam Result 	type of the results, float or int32_t
+	 * @return			status code; all other parameters like getContResults
+	 */
+	template <class FifoEmpty, class FifoFull, class Compensation, class Result>
+	int16_t drainFIFO(Compensation &comp, Result *tempBuffer, uint8_t &tempCount, Result *prsBuffer, uint8_t &prsCount)
+	{
+		BufferSink<Compensation, Result> sink(comp, tempBuffer, tempCount, prsBuffer, prsCount);
+		int16_t ret = drainFIFO<FifoEmpty, FifoFull>(sink);
+		tempCount = sink.m_tempCount;
+		prsCount = sink.m_prsCount;
+		return ret;
+	}
+
+	/**
+	 * The FIFO drain loop: reads raw values in batches and hands them to a sink.
+	 * Reading stops as soon as the sink has no space for a type that is measured.
+	 *
+	 * @param &sink: 	object providing
+	 * 				uint8_t space(uint8_t measureTemp, uint8_t measurePrs): number of values that surely fit
+	 * 				uint8_t put(int32_t raw): takes a raw value, returns 0 if it is dropped
+	 * @return			status code
+	 */
+	template <class FifoEmpty, class FifoFull, class Sink>
+	int16_t drainFIFO(Sink &sink);
+
+	/**
+	 * @brief drainFIFO sink that compensates the results into a buffer for each type
+	 */
+	template <class Compensation, class Result>
+	struct BufferSink
+	{
+		BufferSink(Compensation &comp, Result *tempBuffer, uint8_t tempCapacity, Result *prsBuffer, uint8_t prsCapacity)
+			: m_comp(comp), m_tempBuffer(tempBuffer), m_prsBuffer(prsBuffer),
+			  //without a buffer, results are dropped and do not limit the drain
+			  m_tempCapacity(tempBuffer ? tempCapacity : 0xFFU), m_prsCapacity(prsBuffer ? prsCapacity : 0xFFU),
+			  m_tempCount(0U), m_prsCount(0U)
+		{
+		}
+
+		uint8_t space(uint8_t measureTemp, uint8_t measurePrs)
+		{
+			uint8_t space = 0xFFU;
+			if (measureTemp && m_tempCapacity - m_tempCount < space)
+			{
+				space = m_tempCapacity - m_tempCount;
+			}
+			if (measurePrs && m_prsCapacity - m_prsCount < space)
+			{
+				space = m_prsCapacity - m_prsCount;
+			}
+			return space;
+		}
+
+		uint8_t put(int32_t raw)
+		{
+			//the LSB marks the type of the result
+			if ((raw & 0x01) == 0) //temperature
+			{
+				if (m_tempBuffer && m_tempCount < m_tempCapacity)
+				{
+					m_tempBuffer[m_tempCount++] = m_comp.calcTemp(raw);
+					return 1U;
+				}
+			}
+			else //pressure
+			{
+				if (m_prsBuffer && m_prsCount < m_prsCapacity)
+				{
+					m_prsBuffer[m_prsCount++] = m_comp.calcPressure(raw);
+					return 1U;
+				}
+			}
+			return 0U;
+		}
+
+		Compensation &m_comp;
+		Result *m_tempBuffer;
+		Result *m_prsBuffer;
+		uint8_t m_tempCapacity;
+		uint8_t m_prsCapacity;
+		uint8_t m_tempCount;
+		uint8_t m_prsCount;
+	};
+
+	/**
+	 * @brief drainFIFO sink that keeps the raw values in FIFO order
+	 */
+	struct RawSink
+	{
+		//without a buffer nothing is read, the results stay in the FIFO
+		RawSink(int32_t *raw, uint8_t capacity) : m_raw(raw), m_capacity(raw ? capacity : 0U), m_count(0U) {}
+
+		uint8_t space(uint8_t, uint8_t)
+		{
+			return m_capacity - m_count;
+		}
+
+		uint8_t put(int32_t raw)
+		{
+			m_raw[m_count++] = raw;
+			return 1U;
+		}
+
+		int32_t *m_raw;
+		uint8_t m_capacity;
+		uint8_t m_count;
+	};
+
+	/**
+	 * @brief drainFIFO sink that compensates each result and hands it to a handler
+	 */
+	template <class Compensation, class Result, class Handler>
+	struct SampleSink
+	{
+		SampleSink(DpsClass &dps, Compensation &comp, Handler &handler)
+			: m_comp(comp), m_handler(handler), m_drainTime(millis()), m_lastDrainTime(dps.m_lastDrainTime)
+		{
+			m_period[dps::SAMPLE_TEMP] = 1000000UL >> dps.m_tempMr;
+			m_period[dps::SAMPLE_PRS] = 1000000UL >> dps.m_prsMr;
+			m_count[dps::SAMPLE_TEMP] = 0U;
+			m_count[dps::SAMPLE_PRS] = 0U;
+		}
+
+		//the handler takes all results, the FIFO is always emptied
+		uint8_t space(uint8_t, uint8_t)
+		{
+			return 0xFFU;
+		}
+
+		uint8_t put(int32_t raw)
+		{
+			DpsResult<Result> result;
+			result.type = raw & 0x01;
+			result.raw = raw;
+			result.value = result.type == dps::SAMPLE_PRS ? m_comp.calcPressure(raw) : m_comp.calcTemp(raw);
+			//periods in us, so that they do not add up rounding errors
+			uint32_t count = ++m_count[result.type];
+			result.timestamp = m_lastDrainTime + count * m_period[result.type] / 1000U;
+			if ((long)(result.timestamp - m_drainTime) > 0)
+			{
+				result.timestamp = m_drainTime;
+			}
+			m_handler(result);
+			return 1U;
+		}
+
+		Compensation &m_comp;
+		Handler &m_handler;
+		unsigned long m_drainTime;
+		unsigned long m_lastDrainTime;
+		uint32_t m_period[2];
+		uint16_t m_count[2];
+	};
 
 	/**
 	 * reads a byte from the sensor
@@ -365,6 +1106,24 @@ class DpsClass
 	 */
 	int16_t readByte(uint8_t regAddress);
 
+	/**
+	 * reads a byte from the sensor via I2C
+	 * this function is automatically called by readByte
+	 * if the sensor is connected via I2C
+	 *
+	 * @param regAdress: 	Address that has to be read
+	 * @return 	register content or -1 on fail
+	 */
+	int16_t readByteI2C(uint8_t regAddress);
+
+	/**
+	 * selects the multiplexer channel of the sensor before an I2C access;
+	 * the multiplexer only switches if another channel is selected
+	 *
+	 * @return 	status code
+	 */
+	int16_t selectMuxChannel(void);
+
 #ifndef DPS_DISABLESPI
 	/**
 	 * reads a byte from the sensor via SPI
@@ -386,6 +1145,16 @@ class DpsClass
 	 */
 	int16_t readBlock(RegBlock_t regBlock, uint8_t *buffer);
 
+	/**
+	 * reads a block from the sensor via I2C
+	 *
+	 * @param regAdress: 	Address that has to be read
+	 * @param length: 		Length of data block
+	 * @param buffer: 	Buffer where data will be stored
+	 * @return 	number of bytes that have been read successfully, which might not always equal to length due to rx-Buffer overflow etc.
+	 */
+	int16_t readBlockI2C(RegBlock_t regBlock, uint8_t *buffer);
+
 #ifndef DPS_DISABLESPI
 	/**
 	 * reads a block from the sensor via SPI
@@ -419,6 +1188,16 @@ class DpsClass
 	 */
 	int16_t writeByte(uint8_t regAddress, uint8_t data, uint8_t check);
 
+	/**
+	 * writes a byte to a register of the sensor via I2C
+	 *
+	 * @param regAdress: 	Address of the register that has to be updated
+	 * @param data:		Byte that will be written to the register
+	 * @return		0 if byte was written successfully
+	 * 				or -1 on fail
+	 */
+	int16_t writeByteI2C(uint8_t regAddress, uint8_t data);
+
 #ifndef DPS_DISABLESPI
 	/**
 	 * writes a byte to a register of the sensor via SPI
@@ -443,8 +1222,19 @@ class DpsClass
 	 */
 	int16_t writeByteBitfield(uint8_t data, RegMask_t regMask);
 
+	/**
+	 * returns the cached content of a configuration register (see m_cfgShadow)
+	 * The configuration registers are only changed by the driver, so the cache can replace reading them.
+	 *
+	 * @param regAddress: 	address of the register
+	 * @return		register content, or -1 if it is not cached, contains flags set by the sensor (MEAS_CFG)
+	 * 				or the sensor has been reset and not restored (see m_cfgInSync)
+	 */
+	int16_t getCfgShadow(uint8_t regAddress);
+
 	/**
 	 * updates a bit field of the sensor
+	 * Cached registers are not read, and not written if their content does not change.
 	 *
 	 * regMask: 	Mask of the register that has to be updated
 	 * data:		BitValues that will be written to the register
@@ -464,6 +1254,41 @@ class DpsClass
 	 */
 	int16_t readByteBitfield(RegMask_t regMask);
 
+	/**
+	 * reads a bit field from the sensor
+	 *
+	 * @tparam Field 	the register field as RegField type
+	 * @return		read and processed bits
+	 * 				or -1 on fail
+	 */
+	template <class Field>
+	int16_t readByteBitfield(void)
+	{
+		int16_t ret = readByte(Field::regAddress);
+		if (ret < 0)
+		{
+			return ret;
+		}
+		return Field::decode((uint8_t)ret);
+	}
+
+	/**
+	 * updates one or more bit fields of the same register without checking
+	 * The fields are merged at compile time, so the register is updated by a single read-modify-write.
+	 *
+	 * @tparam Fields 	the register fields as RegField types
+	 * @param values 	one value per field, in the same order
+	 * @return		0 if byte was written successfully
+	 * 				or -1 on fail
+	 */
+	template <class Field, class... Fields, class... Values>
+	int16_t writeByteBitfield(Values... values)
+	{
+		static_assert(1U + sizeof...(Fields) == sizeof...(Values), "one value per register field required");
+		typedef RegFieldSet<Field, Fields...> Set;
+		return writeByteBitfield(Set::encode(values...), Set::regAddress, Set::mask, 0U, 0U);
+	}
+
 	/**
 	 * @brief converts non-32-bit negative numbers to 32-bit negative numbers with 2's complement
 	 * 
@@ -482,4 +1307,143 @@ class DpsClass
 	int16_t getRawResult(int32_t *raw, RegBlock_t reg);
 };
 
+template <class FifoEmpty, class FifoFull, class Sink>
+int16_t DpsClass::drainFIFO(Sink &sink)
+{
+	DPS_API_SCOPE(dps::API_GET_CONT_RESULTS);
+	if (m_initFail)
+	{
+		return DPS__FAIL_INIT_FAILED;
+	}
+	//abort if device is not in background mode
+	if (!(m_opMode & 0x04))
+	{
+		return DPS__FAIL_TOOBUSY;
+	}
+
+	uint8_t measureTemp = m_opMode == dps::CONT_TMP || m_opMode == dps::CONT_BOTH;
+	uint8_t measurePrs = m_opMode == dps::CONT_PRS || m_opMode == dps::CONT_BOTH;
+
+	//a full FIFO has discarded newer results
+	//the fill level is used where the sensor reports it, the full flag of the DPS422 is also set at the watermark
+	int16_t fillLevel = getFIFOFillLevel();
+	int16_t full = fillLevel >= 0 ? fillLevel >= (int16_t)DPS__FIFO_SIZE : readByteBitfield<FifoFull>();
+	unsigned long now = millis();
+	if (full > 0)
+	{
+		m_fifoStats.overruns++;
+		uint32_t rate = (measureTemp ? 1UL << m_tempMr : 0U) + (measurePrs ? 1UL << m_prsMr : 0U);
+		//64 bits, a drain after a long pause would overflow 32 bits
+		uint64_t expected = (uint64_t)(now - m_lastDrainTime) * rate / 1000U;
+		//the results since the last drain only had the room it left
+		uint8_t room = DPS__FIFO_SIZE - m_fifoLeft;
+		if (expected > room)
+		{
+			uint64_t lost = m_fifoStats.lost + (expected - room);
+			m_fifoStats.lost = lost > UINT32_MAX ? UINT32_MAX : (uint32_t)lost;
+		}
+	}
+	m_lastDrainTime = now;
+	m_fifoLeft = 0U;
+
+	//while FIFO is not empty
+	int32_t raw_results[DPS__FIFO_BATCH];
+	int16_t count;
+	while (true)
+	{
+		//only read as many results as surely fit into the sink, the others stay in the FIFO
+		uint8_t space = sink.space(measureTemp, measurePrs);
+		if (space > DPS__FIFO_BATCH)
+		{
+			space = DPS__FIFO_BATCH;
+		}
+		if (space == 0)
+		{
+			//results stay in the FIFO; without a fill level they are not known and taken as 0
+			fillLevel = getFIFOFillLevel();
+			m_fifoLeft = fillLevel > 0 ? fillLevel : 0U;
+			break;
+		}
+		count = getFIFOvalues<FifoEmpty>(raw_results, space);
+		if (count == 0)
+		{
+			break;
+		}
+		//read failed
+		if (count < 0)
+		{
+			//repeated failures: the bus or the sensor is stuck, get the measurement running again
+			if (m_busFailures >= DPS__RECOVERY_THRESHOLD && !m_recovering)
+			{
+				recover();
+			}
+			return DPS__FAIL_UNKNOWN;
+		}
+		for (int16_t i = 0; i < count; i++)
+		{
+			if (sink.put(raw_results[i]))
+			{
+				m_fifoStats.delivered++;
+			}
+			else
+			{
+				m_fifoStats.dropped++;
+			}
+		}
+		//a batch that is not full has emptied the FIFO
+		if (m_SpiI2c == 2 && count < space)
+		{
+			break;
+		}
+	}
+	return DPS__SUCCEEDED;
+}
+
+template <class FifoEmpty>
+int16_t DpsClass::getFIFOvalues(int32_t *raw, uint8_t maxCount)
+{
+	if (m_SpiI2c != 2)
+	{
+		//check FIFO empty flag before each read
+		int16_t empty = readByteBitfield<FifoEmpty>();
+		if (empty != 0)
+		{
+			//FIFO empty or flag could not be read
+			return empty > 0 ? 0 : DPS__FAIL_UNKNOWN;
+		}
+		return getFIFOvalue(raw) < 0 ? DPS__FAIL_UNKNOWN : 1;
+	}
+
+	//read a batch of results in one transfer
+	//if the fill level is unknown, the batch may contain empty markers, which are skipped
+	int16_t fillLevel = getFIFOFillLevel();
+	uint8_t count = (fillLevel >= 0 && fillLevel < maxCount) ? fillLevel : maxCount;
+	if (count == 0)
+	{
+		return 0;
+	}
+	uint8_t buffer[DPS__FIFO_BATCH * DPS__RESULT_BLOCK_LENGTH];
+	DPS_BUS_OP_START(start);
+	int16_t ret = m_transport->readBlocks(dps::registerBlocks[dps::PRS].regAddress, DPS__RESULT_BLOCK_LENGTH, count, buffer);
+	DPS_BUS_OP_RECORD(dps::BUS_OP_READ_BLOCK, start, ret < 0 ? 0U : ret * DPS__RESULT_BLOCK_LENGTH, ret != count);
+	trackBusAccess(ret <= 0);
+	if (ret <= 0)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	//results that arrived after an empty marker are still valid, so they are moved up instead of dropped
+	int16_t valid = 0;
+	for (int16_t i = 0; i < ret; i++)
+	{
+		uint8_t *result = &buffer[i * DPS__RESULT_BLOCK_LENGTH];
+		raw[valid] = (uint32_t)result[0] << 16 | (uint32_t)result[1] << 8 | (uint32_t)result[2];
+		getTwosComplement(&raw[valid], 24);
+		if (raw[valid] != DPS__FIFO_EMPTY_VALUE)
+		{
+			valid++;
+		}
+	}
+	return valid;
+}
+
 #endif //DPSCLASS_H_INCLUDED
@@ -0,0 +1,233 @@
+/**
+ * @brief Burst measurements for battery powered nodes
+ *
+ * DpsDutyCycle wakes the sensor once per period, lets a continuous measurement of temperature and pressure
+ * run until the requested number of pressure results is in the FIFO, reads them and idles the sensor again.
+ * The first burst configures the sensor. All later bursts only resume() and pause() it: configuration
+ * and FIFO stay as they are, and the register cache of the driver skips everything that does not change.
+ * So a burst costs one register write to start, the FIFO reads, and two writes to stop.
+ *
+ * update() is called from loop() and returns the time until it needs to be called again.
+ * The application can sleep or use its radio in the meantime, since the bus is not accessed.
+ *
+ * @file DpsDutyCycle.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSDUTYCYCLE_H_INCLUDED
+#define DPSDUTYCYCLE_H_INCLUDED
+
+#include "DpsClass.h"
+#include "DpsPlanner.h"
+
+/**
+ * @tparam Sensor     Dps310, Dps422 or one of the DpsSensor types
+ * @tparam Capacity   maximum number of results of each type per burst
+ */
+template <class Sensor, uint8_t Capacity = DPS__FIFO_SIZE / 2>
+class DpsDutyCycle
+{
+public:
+  /**
+   * @param &sensor: 	initialized sensor in standby
+   */
+  explicit DpsDutyCycle(Sensor &sensor)
+      : m_sensor(sensor), m_state(STATE_STOPPED), m_started(0U), m_ready(0U), m_status(DPS__SUCCEEDED),
+        m_tempCount(0U), m_prsCount(0U)
+  {
+  }
+
+  /**
+   * sets up the bursts; the first one starts with the next update()
+   *
+   * @param &plan: 	measure rates and oversampling rates, e.g. from dps::planMeasurement()
+   * @param period: 	time from the start of one burst to the start of the next, in ms
+   * @param samples: 	pressure results per burst, 1 ... Capacity
+   * @return 	status code, DPS__FAIL_UNFINISHED if the results do not fit into the FIFO or the burst not into the period
+   */
+  int16_t begin(const DpsPlan_t &plan, unsigned long period, uint8_t samples)
+  {
+    if (samples == 0U || samples > Capacity)
+    {
+      return DPS__FAIL_UNFINISHED;
+    }
+    //temperature results measured during the burst, plus one for the phase between both
+    uint16_t tempSamples = (((uint16_t)samples << plan.tempMr) >> plan.prsMr) + 1U;
+    m_samplePeriod = (1000UL >> plan.prsMr) + 1U;
+    m_burstTime = m_samplePeriod * samples + DPS310__BUSYTIME_FAILSAFE;
+    //the FIFO must hold the whole burst, since it is only read at the end
+    if (tempSamples > Capacity || tempSamples + samples > DPS__FIFO_SIZE || m_burstTime >= period)
+    {
+      return DPS__FAIL_UNFINISHED;
+    }
+    m_plan = plan;
+    m_period = period;
+    m_samples = samples;
+    m_started = 0U;
+    m_ready = 0U;
+    m_state = STATE_SLEEP;
+    m_nextWake = millis();
+    return DPS__SUCCEEDED;
+  }
+
+  /**
+   * stops the bursts and puts the sensor to standby
+   *
+   * @return 	status code of standby()
+   */
+  int16_t end(void)
+  {
+    m_state = STATE_STOPPED;
+    m_started = 0U;
+    return m_sensor.standby();
+  }
+
+  /**
+   * starts, reads and stops the bursts when they are due
+   *
+   * @return 	time in ms until update() needs to be called again
+   */
+  unsigned long update(void)
+  {
+    unsigned long now = millis();
+    switch (m_state)
+    {
+    case STATE_SLEEP:
+      if ((long)(m_nextWake - now) > 0)
+      {
+        return m_nextWake - now;
+      }
+      return wake(now);
+    case STATE_BURST:
+      return collect(now);
+    default:
+      return m_period;
+    }
+  }
+
+  /**
+   * @return 	1 once after each completed burst, whose results can be read then
+   */
+  uint8_t available(void)
+  {
+    uint8_t ready = m_ready;
+    m_ready = 0U;
+    return ready;
+  }
+
+  /**
+   * @param &count: 	number of pressure results of the last burst
+   * @return 	pressure results of the last burst in Pa
+   */
+  const float *getPressures(uint8_t &count) const
+  {
+    count = m_prsCount;
+    return m_prs;
+  }
+
+  /**
+   * @param &count: 	number of temperature results of the last burst
+   * @return 	temperature results of the last burst in °C
+   */
+  const float *getTemperatures(uint8_t &count) const
+  {
+    count = m_tempCount;
+    return m_temp;
+  }
+
+  /**
+   * @return 	status code of the last bus access; a failed burst is repeated in the next period
+   */
+  int16_t getStatus(void) const
+  {
+    return m_status;
+  }
+
+private:
+  enum State_e
+  {
+    STATE_STOPPED,
+    STATE_SLEEP,
+    STATE_BURST,
+  };
+
+  /**
+   * starts a burst and schedules the next one
+   */
+  unsigned long wake(unsigned long now)
+  {
+    //periods missed by a late update() are skipped
+    while ((long)(now - m_nextWake) >= 0)
+    {
+      m_nextWake += m_period;
+    }
+    //the configuration is only written for the first burst
+    m_status = m_started ? m_sensor.resume()
+                         : m_sensor.startMeasureBothCont(m_plan.tempMr, m_plan.tempOsr, m_plan.prsMr, m_plan.prsOsr);
+    if (m_status != DPS__SUCCEEDED)
+    {
+      //start from scratch with the next burst
+      m_started = 0U;
+      return m_nextWake - now;
+    }
+    m_started = 1U;
+    m_burstStart = now;
+    m_tempCount = 0U;
+    m_prsCount = 0U;
+    m_state = STATE_BURST;
+    return m_burstTime;
+  }
+
+  /**
+   * reads the results of the burst and stops it when all are there
+   */
+  unsigned long collect(unsigned long now)
+  {
+    uint8_t tempCount = Capacity - m_tempCount;
+    uint8_t prsCount = Capacity - m_prsCount;
+    m_status = m_sensor.getContResults(&m_temp[m_tempCount], tempCount, &m_prs[m_prsCount], prsCount);
+    m_tempCount += tempCount;
+    m_prsCount += prsCount;
+
+    unsigned long elapsed = now - m_burstStart;
+    //the clock of the sensor may be a bit slower, give it one more sample period
+    if (m_status == DPS__SUCCEEDED && m_prsCount < m_samples && elapsed < m_burstTime + m_samplePeriod)
+    {
+      return m_samplePeriod;
+    }
+
+    int16_t ret = m_sensor.pause();
+    if (ret != DPS__SUCCEEDED)
+    {
+      m_status = ret;
+      m_started = 0U;
+      m_sensor.standby();
+    }
+    m_ready = 1U;
+    m_state = STATE_SLEEP;
+    now = millis();
+    return (long)(m_nextWake - now) > 0 ? m_nextWake - now : 0UL;
+  }
+
+  Sensor &m_sensor;
+
+  DpsPlan_t m_plan;
+  unsigned long m_period;
+  unsigned long m_samplePeriod;
+  unsigned long m_burstTime;
+  uint8_t m_samples;
+
+  uint8_t m_state;
+  uint8_t m_started;
+  uint8_t m_ready;
+  int16_t m_status;
+  unsigned long m_nextWake;
+  unsigned long m_burstStart;
+
+  float m_temp[Capacity];
+  float m_prs[Capacity];
+  uint8_t m_tempCount;
+  uint8_t m_prsCount;
+};
+
+#endif //DPSDUTYCYCLE_H_INCLUDED
@@ -0,0 +1,472 @@
+/**
+ * @brief Fusion of redundant sensors
+ *
+ * The conversion time grows with 2^osr (see DpsClass::calcBusyTime), so averaging N sensors at a low
+ * oversampling rate gives the same noise at a higher rate and lower latency than one sensor at a high one.
+ * DpsFusion runs the same continuous measurement on all sensors and combines their pressure results:
+ *  - the results of all sensors are interpolated to a common point in time
+ *  - the offset of each sensor against the others and its noise are estimated online
+ *  - the fused pressure is the inverse-variance weighted mean of the offset-corrected results
+ *  - results too far away from the median of all sensors are rejected, so a faulty sensor
+ *    does not pull the estimate; this needs at least three sensors
+ *
+ * The offsets are relative: the fused pressure has the weighted mean accuracy of all sensors.
+ *
+ * @file DpsFusion.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSFUSION_H_INCLUDED
+#define DPSFUSION_H_INCLUDED
+
+#include <math.h>
+#include "DpsClass.h"
+#include "DpsPlanner.h"
+
+#ifndef DPS__FUSION_MAX_SENSORS
+#define DPS__FUSION_MAX_SENSORS 4U
+#endif
+// weight of a new residual in the offset and noise estimates is 1 / DPS__FUSION_ADAPTION
+#ifndef DPS__FUSION_ADAPTION
+#define DPS__FUSION_ADAPTION 16
+#endif
+// number of estimates after begin() in which the offsets are learned and no result is rejected
+#ifndef DPS__FUSION_WARMUP
+#define DPS__FUSION_WARMUP 16U
+#endif
+// results further away from the median than this many standard deviations of their sensor are rejected
+#ifndef DPS__FUSION_OUTLIER_SIGMA
+#define DPS__FUSION_OUTLIER_SIGMA 4.0f
+#endif
+
+/**
+ * @tparam Sensor       Dps310, Dps422 or one of the DpsSensor types
+ * @tparam MaxSensors   maximum number of sensors
+ */
+template <class Sensor, uint8_t MaxSensors = DPS__FUSION_MAX_SENSORS>
+class DpsFusion
+{
+public:
+  DpsFusion(void)
+      : m_count(0U), m_estimates(0U), m_time(0UL), m_pressure(0.0f), m_temperature(0.0f), m_variance(0.0f), m_used(0U)
+  {
+  }
+
+  /**
+   * adds an initialized sensor. Sensors behind a multiplexer are accessed grouped by channel.
+   *
+   * @param &sensor: 	the sensor, which must not be measuring
+   * @return 	index of the sensor, or -1 if there are MaxSensors already
+   */
+  int8_t add(Sensor &sensor)
+  {
+    if (m_count >= MaxSensors)
+    {
+      return -1;
+    }
+    //keep sensors on the same multiplexer channel next to each other in the access order,
+    //so that a round over all sensors switches each channel only once
+    uint8_t pos = m_count;
+    for (uint8_t k = 0; k < m_count; k++)
+    {
+      const Sensor *other = m_channels[m_order[k]].sensor;
+      if (other->getMux() == sensor.getMux() && other->getMuxChannel() == sensor.getMuxChannel())
+      {
+        pos = k + 1U;
+      }
+    }
+    for (uint8_t k = m_count; k > pos; k--)
+    {
+      m_order[k] = m_order[k - 1U];
+    }
+    m_order[pos] = m_count;
+    m_channels[m_count].sensor = &sensor;
+    return m_count++;
+  }
+
+  /**
+   * starts the continuous measurement on all sensors and restarts the estimation
+   *
+   * @param &plan: 	measure rates and oversampling rates, e.g. from dps::planMeasurement();
+   * 				the predicted noise is used as lower limit for the noise estimates
+   * @return 	status code of the first sensor that failed to start
+   */
+  int16_t begin(const DpsPlan_t &plan)
+  {
+    DpsPlan_t predicted = plan;
+    if (m_count == 0U || dps::predictMeasurement(predicted) != DPS__SUCCEEDED)
+    {
+      return DPS__FAIL_UNFINISHED;
+    }
+    float noise = predicted.prsNoise / (float)DPS__INT_PRS_SCALE;
+    m_minVariance = noise * noise;
+    m_period = 1000UL >> plan.prsMr;
+    m_estimates = 0U;
+    m_used = 0U;
+
+    int16_t ret = DPS__SUCCEEDED;
+    for (uint8_t k = 0; k < m_count; k++)
+    {
+      Channel &ch = m_channels[m_order[k]];
+      ch.samples = 0U;
+      ch.offset = 0.0f;
+      ch.variance = m_minVariance;
+      ch.outliers = 0U;
+      int16_t started = ch.sensor->startMeasureBothCont(plan.tempMr, plan.tempOsr, plan.prsMr, plan.prsOsr);
+      if (ret == DPS__SUCCEEDED)
+      {
+        ret = started;
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * stops the measurement on all sensors
+   *
+   * @return 	status code of the first sensor that failed
+   */
+  int16_t end(void)
+  {
+    int16_t ret = DPS__SUCCEEDED;
+    for (uint8_t k = 0; k < m_count; k++)
+    {
+      int16_t stopped = m_channels[m_order[k]].sensor->standby();
+      if (ret == DPS__SUCCEEDED)
+      {
+        ret = stopped;
+      }
+    }
+    return ret;
+  }
+
+  /**
+   * reads the new results of all sensors and fuses them
+   *
+   * @return 	1 if there is a new estimate, 0 if not
+   */
+  uint8_t update(void)
+  {
+    unsigned long now = millis();
+    for (uint8_t k = 0; k < m_count; k++)
+    {
+      drain(m_channels[m_order[k]], now);
+    }
+    return fuse();
+  }
+
+  /**
+   * @return 	fused pressure in Pa
+   */
+  float getPressure(void) const
+  {
+    return m_pressure;
+  }
+
+  /**
+   * @return 	standard deviation of the fused pressure in Pa, according to the noise estimates
+   */
+  float getUncertainty(void) const
+  {
+    return sqrtf(m_variance);
+  }
+
+  /**
+   * @return 	mean temperature of the sensors in the last estimate, in °C
+   */
+  float getTemperature(void) const
+  {
+    return m_temperature;
+  }
+
+  /**
+   * @return 	millis() of the point in time the last estimate refers to
+   */
+  unsigned long getTime(void) const
+  {
+    return m_time;
+  }
+
+  /**
+   * @return 	number of sensors in the last estimate
+   */
+  uint8_t getUsed(void) const
+  {
+    return m_used;
+  }
+
+  /**
+   * @param index: 	index of the sensor as returned by add()
+   * @return 	estimated offset of the sensor against the fused pressure, in Pa
+   */
+  float getOffset(uint8_t index) const
+  {
+    return m_channels[index].offset;
+  }
+
+  /**
+   * @param index: 	index of the sensor as returned by add()
+   * @return 	estimated standard deviation of the sensor, in Pa
+   */
+  float getNoise(uint8_t index) const
+  {
+    return sqrtf(m_channels[index].variance);
+  }
+
+  /**
+   * @param index: 	index of the sensor as returned by add()
+   * @return 	number of results of the sensor rejected since begin()
+   */
+  uint16_t getOutliers(uint8_t index) const
+  {
+    return m_channels[index].outliers;
+  }
+
+private:
+  struct Channel
+  {
+    Sensor *sensor;
+    //last two pressure results and their times, for the interpolation
+    float prev;
+    float last;
+    unsigned long prevTime;
+    unsigned long lastTime;
+    uint8_t samples; //valid results in prev and last
+    float temperature;
+    float offset;
+    float variance;
+    uint16_t outliers;
+  };
+
+  /**
+   * reads the FIFO of a sensor and keeps the last two pressure results.
+   * The FIFO has no time stamps: the last result is stamped with the time of reading,
+   * the ones before it one measurement period earlier each.
+   */
+  void drain(Channel &ch, unsigned long now)
+  {
+    float temp[DPS__FIFO_BATCH];
+    float prs[DPS__FIFO_BATCH];
+    uint8_t tempCount;
+    uint8_t prsCount;
+    do
+    {
+      tempCount = DPS__FIFO_BATCH;
+      prsCount = DPS__FIFO_BATCH;
+      if (ch.sensor->getContResults(temp, tempCount, prs, prsCount) != DPS__SUCCEEDED)
+      {
+        return;
+      }
+      if (tempCount > 0U)
+      {
+        ch.temperature = temp[tempCount - 1U];
+      }
+      if (prsCount > 1U)
+      {
+        ch.prev = prs[prsCount - 2U];
+        ch.samples = 2U;
+      }
+      else if (prsCount == 1U)
+      {
+        ch.prev = ch.last;
+        ch.prevTime = ch.lastTime;
+        ch.samples += ch.samples < 2U ? 1U : 0U;
+      }
+      if (prsCount > 0U)
+      {
+        ch.last = prs[prsCount - 1U];
+        ch.lastTime = now;
+      }
+      //results read in an earlier round of this loop are older than the ones of this round
+      if (prsCount > 1U)
+      {
+        ch.prevTime = now - m_period;
+      }
+    } while (tempCount == DPS__FIFO_BATCH || prsCount == DPS__FIFO_BATCH);
+  }
+
+  /**
+   * @return 	pressure of the sensor at time t, interpolated between its last two results
+   */
+  static float valueAt(const Channel &ch, unsigned long t)
+  {
+    if (ch.samples < 2U || (long)(t - ch.lastTime) >= 0 || ch.lastTime == ch.prevTime)
+    {
+      return ch.last;
+    }
+    if ((long)(t - ch.prevTime) <= 0)
+    {
+      return ch.prev;
+    }
+    return ch.prev + (ch.last - ch.prev) * (float)(t - ch.prevTime) / (float)(ch.lastTime - ch.prevTime);
+  }
+
+  /**
+   * @return 	median of n values; sorts them
+   */
+  static float median(float *values, uint8_t n)
+  {
+    for (uint8_t i = 1; i < n; i++)
+    {
+      float v = values[i];
+      uint8_t j = i;
+      for (; j > 0 && values[j - 1] > v; j--)
+      {
+        values[j] = values[j - 1];
+      }
+      values[j] = v;
+    }
+    return (n & 0x01U) ? values[n / 2U] : 0.5f * (values[n / 2U - 1U] + values[n / 2U]);
+  }
+
+  /**
+   * combines the sensors that have recent results at the latest time all of them have reached
+   *
+   * @return 	1 if there is a new estimate, 0 if not
+   */
+  uint8_t fuse(void)
+  {
+    //results older than two measurement periods than the newest one are outdated
+    unsigned long maxAge = 2UL * m_period + DPS310__BUSYTIME_FAILSAFE;
+    uint8_t found = 0U;
+    unsigned long newest = 0UL;
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+      if (m_channels[i].samples > 0U && (!found || (long)(m_channels[i].lastTime - newest) > 0))
+      {
+        newest = m_channels[i].lastTime;
+        found = 1U;
+      }
+    }
+    if (!found)
+    {
+      return 0U;
+    }
+
+    //common time: the oldest of the recent last results, so that the others are interpolated
+    uint8_t fresh[MaxSensors];
+    uint8_t n = 0U;
+    unsigned long t = newest;
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+      const Channel &ch = m_channels[i];
+      if (ch.samples > 0U && newest - ch.lastTime <= maxAge)
+      {
+        fresh[n++] = i;
+        if ((long)(ch.lastTime - t) < 0)
+        {
+          t = ch.lastTime;
+        }
+      }
+    }
+    if (m_estimates > 0U && (long)(t - m_time) <= 0)
+    {
+      return 0U;
+    }
+
+    float raw[MaxSensors];
+    float corrected[MaxSensors];
+    float sorted[MaxSensors];
+    for (uint8_t k = 0; k < n; k++)
+    {
+      raw[k] = valueAt(m_channels[fresh[k]], t);
+      corrected[k] = raw[k] - m_channels[fresh[k]].offset;
+      sorted[k] = corrected[k];
+    }
+    float center = median(sorted, n);
+    uint8_t warmup = m_estimates < DPS__FUSION_WARMUP;
+
+    //the first estimate starts the offsets at the deviation from the median
+    if (m_estimates == 0U)
+    {
+      for (uint8_t k = 0; k < n; k++)
+      {
+        m_channels[fresh[k]].offset = raw[k] - center;
+        corrected[k] = center;
+      }
+    }
+
+    //reject outliers and weight the others by their inverse variance
+    uint8_t inlier[MaxSensors];
+    float weightSum = 0.0f;
+    float sum = 0.0f;
+    float temperature = 0.0f;
+    for (uint8_t k = 0; k < n; k++)
+    {
+      Channel &ch = m_channels[fresh[k]];
+      float deviation = corrected[k] - center;
+      inlier[k] = warmup || n < 3U ||
+                  deviation * deviation <= DPS__FUSION_OUTLIER_SIGMA * DPS__FUSION_OUTLIER_SIGMA * ch.variance;
+      if (!inlier[k])
+      {
+        ch.outliers++;
+        continue;
+      }
+      float weight = 1.0f / ch.variance;
+      weightSum += weight;
+      sum += weight * corrected[k];
+      temperature += ch.temperature;
+    }
+    if (weightSum <= 0.0f)
+    {
+      return 0U;
+    }
+    m_pressure = sum / weightSum;
+    m_variance = 1.0f / weightSum;
+    m_time = t;
+    m_used = 0U;
+
+    //update offset and noise of the sensors that were used
+    float offsetSum = 0.0f;
+    float newWeightSum = 0.0f;
+    for (uint8_t k = 0; k < n; k++)
+    {
+      if (!inlier[k])
+      {
+        continue;
+      }
+      Channel &ch = m_channels[fresh[k]];
+      float residual = raw[k] - m_pressure;
+      ch.offset += (residual - ch.offset) / DPS__FUSION_ADAPTION;
+      float error = residual - ch.offset;
+      ch.variance += (error * error - ch.variance) / DPS__FUSION_ADAPTION;
+      if (ch.variance < m_minVariance)
+      {
+        ch.variance = m_minVariance;
+      }
+      offsetSum += ch.offset / ch.variance;
+      newWeightSum += 1.0f / ch.variance;
+      m_used++;
+    }
+    //keep the weighted mean of the offsets at zero, so that the estimate cannot drift away from the sensors
+    offsetSum /= newWeightSum;
+    for (uint8_t k = 0; k < n; k++)
+    {
+      if (inlier[k])
+      {
+        m_channels[fresh[k]].offset -= offsetSum;
+      }
+    }
+    m_temperature = temperature / m_used;
+    if (m_estimates < 0xFFFFU)
+    {
+      m_estimates++;
+    }
+    return 1U;
+  }
+
+  Channel m_channels[MaxSensors];
+  uint8_t m_order[MaxSensors]; //indices of m_channels in the order of the bus accesses
+  uint8_t m_count;
+  unsigned long m_period;
+  float m_minVariance;
+
+  uint16_t m_estimates;
+  unsigned long m_time;
+  float m_pressure;
+  float m_temperature;
+  float m_variance;
+  uint8_t m_used;
+};
+
+#endif //DPSFUSION_H_INCLUDED
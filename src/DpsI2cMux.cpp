@@ -0,0 +1,70 @@
+#include "DpsI2cMux.h"
+
+DpsI2cMux::DpsI2cMux(TwoWire &bus, uint8_t address)
+	: m_bus(bus), m_address(address), m_control(0U), m_controlValid(0U), m_switches(0U)
+{
+}
+
+int16_t DpsI2cMux::select(uint8_t channel)
+{
+	if (channel >= DPS__MUX_CHANNELS)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	return writeControl((uint8_t)(1U << channel));
+}
+
+int16_t DpsI2cMux::deselect(void)
+{
+	return writeControl(0U);
+}
+
+void DpsI2cMux::invalidate(void)
+{
+	m_controlValid = 0U;
+}
+
+int8_t DpsI2cMux::getChannel(void) const
+{
+	if (!m_controlValid || m_control == 0U)
+	{
+		return -1;
+	}
+	int8_t channel = 0;
+	while (!(m_control & (1U << channel)))
+	{
+		channel++;
+	}
+	return channel;
+}
+
+uint32_t DpsI2cMux::getSwitches(void) const
+{
+	return m_switches;
+}
+
+TwoWire &DpsI2cMux::getBus(void) const
+{
+	return m_bus;
+}
+
+int16_t DpsI2cMux::writeControl(uint8_t control)
+{
+	//the control register keeps its value, so there is nothing to do if it is known
+	if (m_controlValid && m_control == control)
+	{
+		return DPS__SUCCEEDED;
+	}
+	m_switches++;
+	m_bus.beginTransmission(m_address);
+	m_bus.write(control);
+	if (m_bus.endTransmission() != 0)
+	{
+		//the write may or may not have reached the multiplexer
+		m_controlValid = 0U;
+		return DPS__FAIL_UNKNOWN;
+	}
+	m_control = control;
+	m_controlValid = 1U;
+	return DPS__SUCCEEDED;
+}
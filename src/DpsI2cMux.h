@@ -0,0 +1,84 @@
+/**
+ * @brief TCA9548A-style I2C multiplexer
+ *
+ * Both sensors only have the addresses 0x76 and 0x77, so more than two of them on one bus
+ * need a multiplexer. DpsClass::begin(DpsI2cMux &, uint8_t, uint8_t) binds a sensor
+ * to a channel; before each bus access, the sensor selects its channel with select().
+ * The multiplexer remembers the selected channel and only writes its control register
+ * if another channel is selected, so consecutive accesses to sensors on the same channel
+ * cost no extra transfer.
+ *
+ * Only one channel is selected at a time. If several multiplexers are on one bus,
+ * all of them except the one in use must have no channel selected (see deselect()).
+ *
+ * @file DpsI2cMux.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSI2CMUX_H_INCLUDED
+#define DPSI2CMUX_H_INCLUDED
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "util/dps_config.h"
+
+//address of the multiplexer with A0..A2 low
+#define DPS__MUX_STD_ADDRESS 0x70U
+#define DPS__MUX_CHANNELS 8U
+
+class DpsI2cMux
+{
+  public:
+	/**
+	 * @param &bus: 		I2C bus of the multiplexer and of the sensors behind it
+	 * @param address: 	I2C address of the multiplexer (0x70 to 0x77)
+	 */
+	DpsI2cMux(TwoWire &bus, uint8_t address = DPS__MUX_STD_ADDRESS);
+
+	/**
+	 * connects a channel to the bus; does nothing if it is already selected
+	 *
+	 * @param channel: 	0 to DPS__MUX_CHANNELS - 1
+	 * @return 	status code
+	 */
+	int16_t select(uint8_t channel);
+
+	/**
+	 * disconnects all channels from the bus
+	 *
+	 * @return 	status code
+	 */
+	int16_t deselect(void);
+
+	/**
+	 * forgets the selected channel, so that the next select() writes the control register;
+	 * needed after the multiplexer has been reset or written by someone else
+	 */
+	void invalidate(void);
+
+	/**
+	 * @return 	selected channel, -1 if none is selected or it is unknown
+	 */
+	int8_t getChannel(void) const;
+
+	/**
+	 * @return 	number of writes to the control register since construction
+	 */
+	uint32_t getSwitches(void) const;
+
+	/**
+	 * @return 	I2C bus of the multiplexer
+	 */
+	TwoWire &getBus(void) const;
+
+  private:
+	int16_t writeControl(uint8_t control);
+
+	TwoWire &m_bus;
+	uint8_t m_address;
+	uint8_t m_control;		//last value written to the control register
+	uint8_t m_controlValid; //0 if the control register is unknown
+	uint32_t m_switches;
+};
+
+#endif //DPSI2CMUX_H_INCLUDED
@@ -0,0 +1,98 @@
+#include "DpsPlanner.h"
+#include "util/DpsMeasurementConfig.h"
+
+// pressure precision versus oversampling rate according to the datasheet, in 0.01 Pa RMS
+// there is no value for 128 times oversampling, the one of 64 times is assumed
+static const uint16_t prs_noise[DPS__NUM_OF_SCAL_FACTS] = {250, 100, 50, 40, 35, 30, 20, 20};
+
+// 1000 / sqrt(2^osr), for the white noise model of the temperature
+static const uint16_t noise_reduction[DPS__NUM_OF_SCAL_FACTS] = {1000, 707, 500, 354, 250, 177, 125, 88};
+
+int16_t dps::predictMeasurement(DpsPlan_t &plan)
+{
+	uint32_t busyTime = dps::busyTime(plan.tempMr, plan.tempOsr) + dps::busyTime(plan.prsMr, plan.prsOsr);
+	if (busyTime >= DPS310__MAX_BUSYTIME)
+	{
+		return DPS__FAIL_UNFINISHED;
+	}
+	//busy time is given in 0.1 ms per second
+	plan.dutyCycle = busyTime / DPS__BUSYTIME_SCALING;
+	plan.busLoad = (((uint16_t)1U << plan.tempMr) + ((uint16_t)1U << plan.prsMr)) * DPS__PLAN_BUS_BYTES_PER_RESULT;
+	plan.prsNoise = prs_noise[plan.prsOsr];
+	plan.tempNoise = ((uint32_t)DPS__PLAN_TEMP_NOISE_1 * noise_reduction[plan.tempOsr] + 500U) / 1000U;
+	return DPS__SUCCEEDED;
+}
+
+uint32_t dps::drainInterval(const DpsPlan_t &plan)
+{
+	uint32_t interval = DPS__FIFO_SIZE / 2U * 1000U / ((1U << plan.tempMr) + (1U << plan.prsMr));
+	if (interval < DPS__PLAN_MIN_DRAIN_INTERVAL)
+	{
+		return DPS__PLAN_MIN_DRAIN_INTERVAL;
+	}
+	if (interval > DPS__PLAN_MAX_DRAIN_INTERVAL)
+	{
+		return DPS__PLAN_MAX_DRAIN_INTERVAL;
+	}
+	return interval;
+}
+
+int16_t dps::planMeasurement(const DpsPlanRequest_t &request, DpsPlan_t &plan)
+{
+	DpsPlan_t best;
+	uint8_t found = 0U;
+	DpsPlan_t candidate;
+
+	for (candidate.tempMr = 0U; candidate.tempMr < DPS__NUM_OF_SCAL_FACTS; candidate.tempMr++)
+	{
+		//measure rate too low
+		if (((uint16_t)1U << candidate.tempMr) < request.tempRate)
+		{
+			continue;
+		}
+		for (candidate.tempOsr = 0U; candidate.tempOsr < DPS__NUM_OF_SCAL_FACTS; candidate.tempOsr++)
+		{
+			for (candidate.prsMr = 0U; candidate.prsMr < DPS__NUM_OF_SCAL_FACTS; candidate.prsMr++)
+			{
+				if (((uint16_t)1U << candidate.prsMr) < request.prsRate)
+				{
+					continue;
+				}
+				for (candidate.prsOsr = 0U; candidate.prsOsr < DPS__NUM_OF_SCAL_FACTS; candidate.prsOsr++)
+				{
+					//conversions do not fit into one second
+					if (predictMeasurement(candidate) != DPS__SUCCEEDED)
+					{
+						continue;
+					}
+					//check limits
+					if ((request.prsNoise && candidate.prsNoise > request.prsNoise) ||
+						(request.tempNoise && candidate.tempNoise > request.tempNoise) ||
+						(request.maxDutyCycle && candidate.dutyCycle > request.maxDutyCycle) ||
+						(request.maxBusLoad && candidate.busLoad > request.maxBusLoad))
+					{
+						continue;
+					}
+					//keep the candidate if it is better than the best one so far
+					if (!found ||
+						candidate.dutyCycle < best.dutyCycle ||
+						(candidate.dutyCycle == best.dutyCycle &&
+						 (candidate.busLoad < best.busLoad ||
+						  (candidate.busLoad == best.busLoad &&
+						   (uint32_t)candidate.prsNoise * 1000U + candidate.tempNoise < (uint32_t)best.prsNoise * 1000U + best.tempNoise))))
+					{
+						best = candidate;
+						found = 1U;
+					}
+				}
+			}
+		}
+	}
+
+	if (!found)
+	{
+		return DPS__FAIL_UNFINISHED;
+	}
+	plan = best;
+	return DPS__SUCCEEDED;
+}
@@ -0,0 +1,97 @@
+/**
+ * @brief Planner for continuous measurement configurations
+ *
+ * Picking measure rates and oversampling rates by hand against the one second conversion budget
+ * (see DpsClass::calcBusyTime) is error-prone. The planner searches all 8x8x8x8 combinations of
+ * tempMr, tempOsr, prsMr and prsOsr with the busy time model of the sensor and returns the feasible
+ * configuration with the lowest duty cycle, i.e. the lowest power consumption.
+ * Ties are broken by the lower bus load and then by the lower noise.
+ *
+ * @file DpsPlanner.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSPLANNER_H_INCLUDED
+#define DPSPLANNER_H_INCLUDED
+
+#include <Arduino.h>
+#include "util/dps_config.h"
+
+// bus bytes per FIFO result: FIFO empty check and result read, each with slave address, register and repeated start (I2C)
+#define DPS__PLAN_BUS_BYTES_PER_RESULT 10U
+
+// assumed temperature noise of a single measurement without oversampling, in 0.001 °C
+// the planner assumes white noise, i.e. an improvement by sqrt(2) per oversampling step
+#ifndef DPS__PLAN_TEMP_NOISE_1
+#define DPS__PLAN_TEMP_NOISE_1 20U
+#endif
+
+// limits of the FIFO drain interval returned by dps::drainInterval(), in ms
+#define DPS__PLAN_MIN_DRAIN_INTERVAL 5U
+#define DPS__PLAN_MAX_DRAIN_INTERVAL 500U
+
+/**
+ * @brief requirements for a continuous measurement of temperature and pressure
+ *
+ * A value of 0 means that there is no requirement / no limit.
+ */
+typedef struct
+{
+    uint8_t prsRate;       // required pressure results per second (1 - 128)
+    uint8_t tempRate;      // required temperature results per second (1 - 128)
+    uint16_t prsNoise;     // maximum pressure noise in 0.01 Pa RMS
+    uint16_t tempNoise;    // maximum temperature noise in 0.001 °C RMS
+    uint16_t maxDutyCycle; // maximum share of time the sensor converts, in 0.1 % (power limit)
+    uint16_t maxBusLoad;   // maximum bus traffic for reading the results, in bytes per second
+} DpsPlanRequest_t;
+
+/**
+ * @brief configuration chosen by the planner and its predicted properties
+ */
+typedef struct
+{
+    uint8_t tempMr;
+    uint8_t tempOsr;
+    uint8_t prsMr;
+    uint8_t prsOsr;
+    uint16_t prsNoise;  // predicted pressure noise in 0.01 Pa RMS
+    uint16_t tempNoise; // predicted temperature noise in 0.001 °C RMS
+    uint16_t dutyCycle; // share of time the sensor converts, in 0.1 %
+    uint16_t busLoad;   // bus traffic for reading the results, in bytes per second
+} DpsPlan_t;
+
+namespace dps
+{
+
+/**
+ * @brief finds the best feasible configuration for the given requirements
+ *
+ * The result can be passed to DpsClass::startMeasureBothCont(plan.tempMr, plan.tempOsr, plan.prsMr, plan.prsOsr).
+ *
+ * @param request requirements
+ * @param plan the chosen configuration; only written on success
+ * @return DPS__SUCCEEDED, or DPS__FAIL_UNFINISHED if no configuration meets all requirements
+ */
+int16_t planMeasurement(const DpsPlanRequest_t &request, DpsPlan_t &plan);
+
+/**
+ * @brief predicts the properties of a configuration
+ *
+ * @param plan configuration in tempMr, tempOsr, prsMr and prsOsr; the predictions are filled in
+ * @return DPS__SUCCEEDED, or DPS__FAIL_UNFINISHED if the conversions do not fit into one second
+ */
+int16_t predictMeasurement(DpsPlan_t &plan);
+
+/**
+ * @brief interval at which to drain the FIFO in continuous mode
+ *
+ * The FIFO is about half full after this time, so a late drain does not lose results.
+ *
+ * @param plan configuration in tempMr and prsMr
+ * @return interval in ms, limited to DPS__PLAN_MIN_DRAIN_INTERVAL - DPS__PLAN_MAX_DRAIN_INTERVAL
+ */
+uint32_t drainInterval(const DpsPlan_t &plan);
+
+} // namespace dps
+
+#endif //DPSPLANNER_H_INCLUDED
@@ -0,0 +1,114 @@
+/**
+ * @brief Compile time specialized sensor
+ *
+ * DpsSensor<Dps310Traits> and DpsSensor<Dps422Traits> behave exactly like Dps310 and Dps422,
+ * but the FIFO drain loop in getContResults binds calcTemp/calcPressure at compile time.
+ * This removes the two indirect calls per FIFO sample and allows the compiler to inline
+ * the compensation into the loop.
+ * Since only the chip that is used gets instantiated, the code of the other chip is dropped by the linker.
+ *
+ * The bus is still selected at runtime by begin(); this is a plain branch, not a virtual call.
+ *
+ * @file DpsSensor.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSSENSOR_H_INCLUDED
+#define DPSSENSOR_H_INCLUDED
+
+#include "Dps310.h"
+#include "Dps422.h"
+
+template <class Traits>
+class DpsSensor final : public Traits::Chip
+{
+  typedef typename Traits::Chip Chip;
+
+public:
+  /**
+   * Gets the results from continuous measurements and writes them to given arrays
+   * see DpsClass::getContResults
+   */
+  int16_t getContResults(float *tempBuffer, uint8_t &tempCount, float *prsBuffer, uint8_t &prsCount)
+  {
+    StaticCompensation comp(*this);
+    return this->template drainFIFO<typename Traits::FifoEmpty, typename Traits::FifoFull>(comp, tempBuffer, tempCount, prsBuffer, prsCount);
+  }
+
+  /**
+   * Gets the results from continuous measurements as integers in 0.001 °C and 0.01 Pa
+   * see DpsClass::getContResults
+   */
+  int16_t getContResults(int32_t *tempBuffer, uint8_t &tempCount, int32_t *prsBuffer, uint8_t &prsCount)
+  {
+    StaticIntCompensation comp(*this);
+    return this->template drainFIFO<typename Traits::FifoEmpty, typename Traits::FifoFull>(comp, tempBuffer, tempCount, prsBuffer, prsCount);
+  }
+
+  /**
+   * Hands each result of a continuous measurement to handler while the FIFO is drained
+   * see DpsClass::getContSamples
+   */
+  template <class Handler>
+  int16_t getContSamples(Handler &handler)
+  {
+    StaticCompensation comp(*this);
+    return DpsClass::template getContSamples<typename Traits::FifoEmpty, typename Traits::FifoFull, float>(comp, handler);
+  }
+
+  /**
+   * Like getContSamples, with results in 0.001 °C and 0.01 Pa
+   */
+  template <class Handler>
+  int16_t getContSamplesInt(Handler &handler)
+  {
+    StaticIntCompensation comp(*this);
+    return DpsClass::template getContSamples<typename Traits::FifoEmpty, typename Traits::FifoFull, int32_t>(comp, handler);
+  }
+
+private:
+  /**
+   * calls the compensation of the chip without virtual dispatch
+   */
+  struct StaticCompensation
+  {
+    explicit StaticCompensation(DpsSensor &sensor) : m_sensor(sensor) {}
+
+    float calcTemp(int32_t raw)
+    {
+      return m_sensor.Chip::calcTemp(raw);
+    }
+
+    float calcPressure(int32_t raw)
+    {
+      return m_sensor.Chip::calcPressure(raw);
+    }
+
+    DpsSensor &m_sensor;
+  };
+
+  /**
+   * calls the integer compensation of the chip without virtual dispatch
+   */
+  struct StaticIntCompensation
+  {
+    explicit StaticIntCompensation(DpsSensor &sensor) : m_sensor(sensor) {}
+
+    int32_t calcTemp(int32_t raw)
+    {
+      return m_sensor.Chip::calcTempInt(raw);
+    }
+
+    int32_t calcPressure(int32_t raw)
+    {
+      return m_sensor.Chip::calcPressureInt(raw);
+    }
+
+    DpsSensor &m_sensor;
+  };
+};
+
+typedef DpsSensor<Dps310Traits> Dps310Sensor;
+typedef DpsSensor<Dps422Traits> Dps422Sensor;
+
+#endif //DPSSENSOR_H_INCLUDED
@@ -0,0 +1,118 @@
+/**
+ * @brief Interface for buses other than the Arduino TwoWire and SPIClass
+ *
+ * DpsClass::begin(DpsTransport &) connects a sensor through an implementation of this interface,
+ * e.g. a Linux i2c-dev or spidev backend. Implementations get whole register accesses,
+ * so they can map each of them to a single bus transfer.
+ *
+ * DpsClass marks register sequences (initialization, configuration) as batch.
+ * Within a batch, an implementation may defer writes and send them together with the next read,
+ * the next flush() or endBatch(). Results of deferred writes are reported there.
+ *
+ * @file DpsTransport.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSTRANSPORT_H_INCLUDED
+#define DPSTRANSPORT_H_INCLUDED
+
+#include <Arduino.h>
+#include "util/dps_config.h"
+
+class DpsTransport
+{
+  public:
+	virtual ~DpsTransport(void) {}
+
+	/**
+	 * prepares the bus; called by DpsClass::begin()
+	 *
+	 * @return 	0 on success, -1 on fail
+	 */
+	virtual int16_t begin(void)
+	{
+		return DPS__SUCCEEDED;
+	}
+
+	/**
+	 * reads consecutive registers from the sensor
+	 *
+	 * @param regAddress: 	Address of the first register
+	 * @param length: 		Number of registers to read
+	 * @param buffer: 		Buffer where data will be stored
+	 * @return 	number of bytes that have been read successfully or -1 on fail
+	 */
+	virtual int16_t readBlock(uint8_t regAddress, uint8_t length, uint8_t *buffer) = 0;
+
+	/**
+	 * writes a byte to a register of the sensor
+	 *
+	 * @param regAddress: 	Address of the register
+	 * @param data: 		Byte that will be written to the register
+	 * @return 	0 if byte was written successfully or -1 on fail
+	 */
+	virtual int16_t writeByte(uint8_t regAddress, uint8_t data) = 0;
+
+	/**
+	 * reads the same register block several times in a row, e.g. to drain the FIFO.
+	 * Implementations should do this with as few bus transfers as possible;
+	 * the default implementation calls readBlock count times.
+	 *
+	 * @param regAddress: 	Address of the first register of the block
+	 * @param length: 		Length of the block
+	 * @param count: 		Number of reads
+	 * @param buffer: 		Buffer for count * length bytes
+	 * @return 	number of blocks that have been read completely or -1 on fail
+	 */
+	virtual int16_t readBlocks(uint8_t regAddress, uint8_t length, uint8_t count, uint8_t *buffer)
+	{
+		for (uint8_t i = 0; i < count; i++)
+		{
+			if (readBlock(regAddress, length, buffer + (uint16_t)i * length) != length)
+			{
+				return i == 0 ? DPS__FAIL_UNKNOWN : i;
+			}
+		}
+		return count;
+	}
+
+	/**
+	 * starts a batch; batches may be nested, only the outermost one counts
+	 */
+	virtual void beginBatch(void)
+	{
+	}
+
+	/**
+	 * ends a batch and sends deferred writes
+	 *
+	 * @return 	0 if all deferred writes were sent successfully, -1 on fail
+	 */
+	virtual int16_t endBatch(void)
+	{
+		return DPS__SUCCEEDED;
+	}
+
+	/**
+	 * sends deferred writes immediately, e.g. before waiting for a measurement
+	 *
+	 * @return 	0 if all deferred writes were sent successfully, -1 on fail
+	 */
+	virtual int16_t flush(void)
+	{
+		return DPS__SUCCEEDED;
+	}
+
+	/**
+	 * brings the bus back to a defined state after repeated failures, e.g. I2C bus clear or SPI resync;
+	 * called by DpsClass::recover(). Deferred writes are dropped.
+	 *
+	 * @return 	0 on success, -1 on fail
+	 */
+	virtual int16_t recover(void)
+	{
+		return DPS__SUCCEEDED;
+	}
+};
+
+#endif //DPSTRANSPORT_H_INCLUDED
@@ -0,0 +1,131 @@
+#include "DpsTrim.h"
+#include <string.h>
+
+int16_t dps::fitTrim(const DpsTrimPoint_t *points, uint8_t count, DpsTrim_t &trim)
+{
+	if (points == NULL || count == 0U)
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	//means first, the fit uses values relative to them, which keeps float precision at 100 kPa
+	float prsMean = 0.0f;
+	float tempMean = 0.0f;
+	float errMean = 0.0f;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		prsMean += points[i].measured;
+		tempMean += points[i].temperature;
+		errMean += points[i].reference - points[i].measured;
+	}
+	prsMean /= count;
+	tempMean /= count;
+	errMean /= count;
+
+	float spp = 0.0f, stt = 0.0f, spt = 0.0f, spe = 0.0f, ste = 0.0f;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		float p = points[i].measured - prsMean;
+		float t = points[i].temperature - tempMean;
+		float e = points[i].reference - points[i].measured - errMean;
+		spp += p * p;
+		stt += t * t;
+		spt += p * t;
+		spe += p * e;
+		ste += t * e;
+	}
+
+	//error = errMean + gainError * p + tempCoeff * t
+	uint8_t fitGain = spp > DPS__TRIM_MIN_PRS_SPREAD * DPS__TRIM_MIN_PRS_SPREAD * count;
+	uint8_t fitTemp = stt > DPS__TRIM_MIN_TEMP_SPREAD * DPS__TRIM_MIN_TEMP_SPREAD * count;
+	float det = spp * stt - spt * spt;
+	//pressure and temperature changed together, so their effects cannot be told apart
+	if (fitGain && fitTemp && det <= 0.01f * spp * stt)
+	{
+		fitTemp = 0U;
+	}
+	float gainError = 0.0f;
+	float tempCoeff = 0.0f;
+	if (fitGain && fitTemp)
+	{
+		gainError = (spe * stt - ste * spt) / det;
+		tempCoeff = (ste * spp - spe * spt) / det;
+	}
+	else if (fitGain)
+	{
+		gainError = spe / spp;
+	}
+	else if (fitTemp)
+	{
+		tempCoeff = ste / stt;
+	}
+
+	//back to P' = prsOffset + prsGain * P + prsTempCoeff * (T - DPS__TRIM_REF_TEMP)
+	trim.prsGain = 1.0f + gainError;
+	trim.prsTempCoeff = tempCoeff;
+	trim.prsOffset = errMean - gainError * prsMean - tempCoeff * (tempMean - DPS__TRIM_REF_TEMP);
+	return DPS__SUCCEEDED;
+}
+
+// CRC-8 with polynomial 0x31 and init 0xFF
+static uint8_t trimCrc(const uint8_t *data, uint8_t length)
+{
+	uint8_t crc = 0xFFU;
+	for (uint8_t i = 0; i < length; i++)
+	{
+		crc ^= data[i];
+		for (uint8_t bit = 0; bit < 8U; bit++)
+		{
+			crc = (crc & 0x80U) ? (uint8_t)((crc << 1) ^ 0x31U) : (uint8_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+static void putFloat(uint8_t *buffer, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	for (uint8_t i = 0; i < 4U; i++)
+	{
+		buffer[i] = (uint8_t)(bits >> (8U * i));
+	}
+}
+
+static float getFloat(const uint8_t *buffer)
+{
+	uint32_t bits = 0U;
+	for (uint8_t i = 0; i < 4U; i++)
+	{
+		bits |= (uint32_t)buffer[i] << (8U * i);
+	}
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void dps::serializeTrim(const DpsTrim_t &trim, uint8_t productId, uint8_t revisionId, uint8_t *buffer)
+{
+	buffer[0] = DPS__TRIM_FORMAT;
+	buffer[1] = productId;
+	buffer[2] = revisionId;
+	putFloat(&buffer[3], trim.prsOffset);
+	putFloat(&buffer[7], trim.prsGain);
+	putFloat(&buffer[11], trim.prsTempCoeff);
+	putFloat(&buffer[15], trim.tempOffset);
+	buffer[DPS__TRIM_BLOB_LENGTH - 1U] = trimCrc(buffer, DPS__TRIM_BLOB_LENGTH - 1U);
+}
+
+int16_t dps::deserializeTrim(const uint8_t *buffer, DpsTrim_t &trim, uint8_t &productId, uint8_t &revisionId)
+{
+	if (buffer[0] != DPS__TRIM_FORMAT || trimCrc(buffer, DPS__TRIM_BLOB_LENGTH - 1U) != buffer[DPS__TRIM_BLOB_LENGTH - 1U])
+	{
+		return DPS__FAIL_UNKNOWN;
+	}
+	productId = buffer[1];
+	revisionId = buffer[2];
+	trim.prsOffset = getFloat(&buffer[3]);
+	trim.prsGain = getFloat(&buffer[7]);
+	trim.prsTempCoeff = getFloat(&buffer[11]);
+	trim.tempOffset = getFloat(&buffer[15]);
+	return DPS__SUCCEEDED;
+}
@@ -0,0 +1,105 @@
+/**
+ * @brief User calibration trims
+ *
+ * Units calibrated against a reference barometer get a trim of their results:
+ *   P' = prsOffset + prsGain * P + prsTempCoeff * (T - DPS__TRIM_REF_TEMP)
+ *   T' = T + tempOffset
+ * with P and T the results without trim. DpsClass::setTrim() folds the trim into the compensation
+ * coefficients, so trimmed results cost no more than untrimmed ones.
+ * dps::fitTrim() computes the pressure trim from several calibration points, and
+ * DpsClass::saveTrim() / loadTrim() store it together with the product and revision ID of the sensor,
+ * e.g. in an EEPROM.
+ *
+ * @file DpsTrim.h
+ * @author Infineon Technologies
+ */
+
+#ifndef DPSTRIM_H_INCLUDED
+#define DPSTRIM_H_INCLUDED
+
+#include <Arduino.h>
+#include "util/dps_config.h"
+
+// temperature at which the temperature dependent pressure offset is 0, in °C
+#define DPS__TRIM_REF_TEMP 25.0f
+
+// serialized trim: format version, product ID, revision ID, 4 floats (little endian) and a CRC-8
+#define DPS__TRIM_FORMAT 1U
+#define DPS__TRIM_BLOB_LENGTH 20U
+
+// minimum spread (standard deviation) of the calibration points to fit the gain, in Pa,
+// and to fit the temperature coefficient, in °C
+#ifndef DPS__TRIM_MIN_PRS_SPREAD
+#define DPS__TRIM_MIN_PRS_SPREAD 100.0f
+#endif
+#ifndef DPS__TRIM_MIN_TEMP_SPREAD
+#define DPS__TRIM_MIN_TEMP_SPREAD 1.0f
+#endif
+
+// largest gain and temperature coefficient (in Pa per °C) accepted by DpsClass::setTrim();
+// they keep the integer compensation in 64 bits for all raw values (see DpsFixedPoint.h)
+#define DPS__TRIM_MAX_GAIN 2.0f
+#define DPS__TRIM_MAX_TEMP_COEFF 1000.0f
+
+/**
+ * @brief trim of the results of one sensor; all 0 except prsGain = 1 means no trim
+ */
+typedef struct
+{
+    float prsOffset;    // in Pa
+    float prsGain;      // 1.0 without trim
+    float prsTempCoeff; // temperature dependent pressure offset in Pa per °C
+    float tempOffset;   // in °C
+} DpsTrim_t;
+
+/**
+ * @brief one calibration point for dps::fitTrim()
+ */
+typedef struct
+{
+    float measured;    // pressure of the sensor without trim, in Pa
+    float reference;   // pressure of the reference barometer, in Pa
+    float temperature; // temperature of the sensor without trim, in °C
+} DpsTrimPoint_t;
+
+namespace dps
+{
+
+/**
+ * @brief fits the pressure trim to calibration points by least squares
+ *
+ * The offset is always fitted. The gain needs points at different pressures and the temperature coefficient
+ * points at different temperatures (see DPS__TRIM_MIN_PRS_SPREAD and DPS__TRIM_MIN_TEMP_SPREAD);
+ * otherwise they stay at 1 and 0. The temperature offset is not touched, it cannot be fitted from pressures.
+ *
+ * @param points calibration points
+ * @param count number of points
+ * @param trim the fitted trim; only the pressure fields are written
+ * @return DPS__SUCCEEDED, or DPS__FAIL_UNKNOWN without points
+ */
+int16_t fitTrim(const DpsTrimPoint_t *points, uint8_t count, DpsTrim_t &trim);
+
+/**
+ * @brief serializes a trim with the identity of its sensor
+ *
+ * @param trim the trim
+ * @param productId product ID of the sensor (DpsClass::getProductId)
+ * @param revisionId revision ID of the sensor (DpsClass::getRevisionId)
+ * @param buffer DPS__TRIM_BLOB_LENGTH bytes
+ */
+void serializeTrim(const DpsTrim_t &trim, uint8_t productId, uint8_t revisionId, uint8_t *buffer);
+
+/**
+ * @brief reads a trim written by serializeTrim
+ *
+ * @param buffer DPS__TRIM_BLOB_LENGTH bytes
+ * @param trim the trim; only written on success
+ * @param productId product ID of the sensor the trim belongs to
+ * @param revisionId revision ID of the sensor the trim belongs to
+ * @return DPS__SUCCEEDED, or DPS__FAIL_UNKNOWN if the format or checksum is wrong
+ */
+int16_t deserializeTrim(const uint8_t *buffer, DpsTrim_t &trim, uint8_t &productId, uint8_t &revisionId);
+
+} // namespace dps
+
+#endif //DPSTRIM_H_INCLUDED
@@ -0,0 +1,163 @@
+/**
+ * Optional bus instrumentation for DpsClass
+ *
+ * Define DPS_ENABLE_BUS_STATS (e.g. as build flag, like DPS_DISABLESPI) to count
+ * calls, bytes and failures of every bus access and to attribute the resulting
+ * transactions to the public API call that caused them.
+ * Define DPS_BUS_STATS_TIMING in addition to accumulate the time spent in each access.
+ * The clock defaults to micros(); define DPS_BUS_STATS_CLOCK() to use e.g. a cycle counter.
+ *
+ * Without DPS_ENABLE_BUS_STATS all hooks expand to nothing.
+ */
+
+#ifndef DPSBUSSTATS_H_INCLUDED
+#define DPSBUSSTATS_H_INCLUDED
+
+#include <Arduino.h>
+
+namespace dps
+{
+
+/**
+ * @brief low level bus accesses that are counted
+ *
+ * READ_BYTE, READ_BLOCK and WRITE_BYTE are single bus transactions.
+ * WRITE_BITFIELD is a read-modify-write and shows up as READ_BYTE and WRITE_BYTE as well.
+ */
+enum BusOp_e
+{
+    BUS_OP_READ_BYTE = 0,
+    BUS_OP_READ_BLOCK,
+    BUS_OP_WRITE_BYTE,
+    BUS_OP_WRITE_BITFIELD,
+    NUM_OF_BUS_OPS
+};
+
+/**
+ * @brief public API calls the bus traffic is attributed to
+ *
+ * Nested calls (e.g. measureTempOnce calling startMeasureTempOnce) are attributed to the outermost call.
+ */
+enum Api_e
+{
+    API_NONE = 0, // traffic outside of any public call
+    API_BEGIN,
+    API_END,
+    API_STANDBY,
+    API_MEASURE_TEMP_ONCE,
+    API_START_MEASURE_TEMP_ONCE,
+    API_MEASURE_PRESSURE_ONCE,
+    API_START_MEASURE_PRESSURE_ONCE,
+    API_MEASURE_BOTH_ONCE,
+    API_GET_SINGLE_RESULT,
+    API_START_MEASURE_TEMP_CONT,
+    API_START_MEASURE_PRESSURE_CONT,
+    API_START_MEASURE_BOTH_CONT,
+    API_GET_CONT_RESULTS,
+    API_GET_INT_STATUS,
+    API_SET_INTERRUPT_SOURCES,
+    API_CORRECT_TEMP,
+    API_RECOVER,
+    API_PAUSE,
+    API_RESUME,
+    NUM_OF_APIS
+};
+
+typedef struct
+{
+    uint32_t calls;
+    uint32_t bytes;    // payload bytes transferred (without register address)
+    uint32_t failures;
+    uint32_t time;     // accumulated time in DPS_BUS_STATS_CLOCK() ticks, 0 without DPS_BUS_STATS_TIMING
+} BusOpStats_t;
+
+typedef struct
+{
+    uint32_t calls;
+    uint32_t transactions; // bus transactions caused by the calls
+} ApiStats_t;
+
+typedef struct
+{
+    BusOpStats_t ops[NUM_OF_BUS_OPS];
+    ApiStats_t apis[NUM_OF_APIS];
+    uint8_t currentApi;
+} BusStats_t;
+
+#ifdef DPS_ENABLE_BUS_STATS
+
+#ifdef DPS_BUS_STATS_TIMING
+#ifndef DPS_BUS_STATS_CLOCK
+#define DPS_BUS_STATS_CLOCK() micros()
+#endif
+#define DPS_BUS_STATS_NOW() ((uint32_t)DPS_BUS_STATS_CLOCK())
+#else
+#define DPS_BUS_STATS_NOW() 0U
+#endif
+
+/**
+ * @brief adds one bus access to the statistics
+ *
+ * @param stats statistics of the sensor instance
+ * @param op the access type as defined by BusOp_e
+ * @param start timestamp taken before the access
+ * @param bytes payload bytes transferred
+ * @param failed nonzero if the access failed
+ */
+inline void recordBusOp(BusStats_t &stats, uint8_t op, uint32_t start, uint16_t bytes, uint8_t failed)
+{
+    BusOpStats_t &opStats = stats.ops[op];
+    opStats.calls++;
+    opStats.bytes += bytes;
+    opStats.failures += failed ? 1U : 0U;
+    opStats.time += DPS_BUS_STATS_NOW() - start;
+    //bitfield writes are composed of a read and a write, which are counted themselves
+    if (op != BUS_OP_WRITE_BITFIELD)
+    {
+        stats.apis[stats.currentApi].transactions++;
+    }
+}
+
+/**
+ * @brief attributes all bus traffic during its lifetime to a public API call
+ */
+class ApiScope
+{
+  public:
+    ApiScope(BusStats_t &stats, uint8_t api) : m_stats(stats), m_outer(stats.currentApi == API_NONE)
+    {
+        if (m_outer)
+        {
+            m_stats.currentApi = api;
+            m_stats.apis[api].calls++;
+        }
+    }
+
+    ~ApiScope(void)
+    {
+        if (m_outer)
+        {
+            m_stats.currentApi = API_NONE;
+        }
+    }
+
+  private:
+    BusStats_t &m_stats;
+    uint8_t m_outer;
+};
+
+#define DPS_API_SCOPE(api) dps::ApiScope dpsApiScope_(m_busStats, (api))
+#define DPS_BUS_OP_START(start) uint32_t start = DPS_BUS_STATS_NOW()
+#define DPS_BUS_OP_RECORD(op, start, bytes, failed) dps::recordBusOp(m_busStats, (op), (start), (bytes), (failed))
+
+#else
+
+#define DPS_API_SCOPE(api)
+#define DPS_BUS_OP_START(start)
+#define DPS_BUS_OP_RECORD(op, start, bytes, failed)
+
+#endif
+
+} // namespace dps
+
+#endif //DPSBUSSTATS_H_INCLUDED
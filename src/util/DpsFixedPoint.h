@@ -0,0 +1,159 @@
+/**
+ * @brief Fixed point helpers for the integer compensation
+ *
+ * Scaled raw values are Q24 numbers (24 fractional bits), compensation intermediates are Q16 numbers
+ * in units of Pa or °C. All products are calculated with 64 bits, so there is no float arithmetic
+ * between the result registers and the integer results.
+ *
+ * Bounds of the pressure polynomials, which must hold for every 24 bit raw value, not only for the physical range:
+ *  - |raw| <= 2^23 and the smallest scaling factor is 253952 > 2^17.9, so a scaled value |p| < 33.1 < 2^5.05.
+ *    In the nonlinear terms it is a Q22 number (DPS__INT_SCALED_BITS), below 2^27.05.
+ *  - the coefficients of the nonlinear terms are Q8 numbers in Pa (DPS__INT_COEF_BITS). The largest ones are
+ *    16 bit values (DPS310) times the trim gain, which setTrim limits to DPS__TRIM_MAX_GAIN = 2, so they stay
+ *    below 2^24. c00 and c10 are Q16 numbers; c10 * raw is below 2^21 * 2^16 * 2^23 = 2^60.
+ *  - the longest chain is the cubic term of the DPS310, ((c30 * p + c20) * p) * p:
+ *    2^24 * 2^27.05 = 2^51.05 -> Q8 below 2^29.1, * 2^27.05 = 2^56.15 -> 2^34.15, * 2^27.05 = 2^61.2 < 2^63.
+ *    All other products are smaller; the temperature terms of the DPS422 are limited by DPS__INT_SCALED_LIMIT.
+ *  - in the temperature chain of the DPS310, t * (c01 + p * (c11 + p * c21)), c01 also holds prsTempCoeff * c1,
+ *    which setTrim limits with DPS__TRIM_MAX_TEMP_COEFF to 2^21 Pa (2^29 as Q8 number): below 2^61.3.
+ *  - the sum in Q16 Pa is below 2^50, times DPS__INT_PRS_SCALE below 2^57; saturateInt32 limits the result.
+ */
+
+#ifndef DPSFIXEDPOINT_H_INCLUDED
+#define DPSFIXEDPOINT_H_INCLUDED
+
+#include <Arduino.h>
+
+// fractional bits of scaled raw values in the nonlinear terms of the pressure compensation
+#define DPS__INT_SCALED_BITS 22
+// fractional bits of the coefficients of the nonlinear terms and of their intermediates, in Pa
+#define DPS__INT_COEF_BITS 8
+// limit of temperature terms that have a pole (DPS422), as Q22 number: |t| <= 8
+#define DPS__INT_SCALED_LIMIT ((int64_t)8 << DPS__INT_SCALED_BITS)
+
+namespace dps
+{
+
+/**
+ * @brief value of x as Q24 number
+ */
+inline int64_t toQ24(int64_t x)
+{
+    //multiplication instead of shift, a left shift of negative numbers is undefined
+    return x * ((int64_t)1 << 24);
+}
+
+/**
+ * @brief value of x as Q22 number
+ */
+inline int64_t toQ22(int64_t x)
+{
+    return x * ((int64_t)1 << DPS__INT_SCALED_BITS);
+}
+
+/**
+ * @brief value of x as Q16 number
+ */
+inline int64_t toQ16(int64_t x)
+{
+    return x * ((int64_t)1 << 16);
+}
+
+/**
+ * @brief value of x as Q16 number, rounded; exact for integers up to 2^24
+ */
+inline int64_t floatToQ16(float x)
+{
+    return (int64_t)(x * 65536.0f + (x < 0.0f ? -0.5f : 0.5f));
+}
+
+/**
+ * @brief value of x as Q8 number, rounded
+ */
+inline int64_t floatToQ8(float x)
+{
+    return (int64_t)(x * 256.0f + (x < 0.0f ? -0.5f : 0.5f));
+}
+
+/**
+ * @brief x rounded to the nearest integer
+ */
+inline int32_t roundToInt(float x)
+{
+    return (int32_t)(x + (x < 0.0f ? -0.5f : 0.5f));
+}
+
+/**
+ * @brief division rounded to the nearest integer
+ *
+ * @param den   divisor, has to be positive
+ */
+inline int64_t divRound(int64_t num, int64_t den)
+{
+    return num >= 0 ? (num + den / 2) / den : (num - den / 2) / den;
+}
+
+/**
+ * @brief quotient rounded to the nearest integer and limited to -limit..limit
+ *
+ * @param den   divisor of any sign, also 0 (the quotient is limited then)
+ * @param limit positive
+ */
+inline int64_t divLimited(int64_t num, int64_t den, int64_t limit)
+{
+    if (den < 0)
+    {
+        num = -num;
+        den = -den;
+    }
+    if ((num >= 0 ? num : -num) / limit >= den)
+    {
+        return num >= 0 ? limit : -limit;
+    }
+    return divRound(num, den);
+}
+
+/**
+ * @brief product of x and the Q24 number q, rounded; x keeps its format
+ */
+inline int64_t mulQ24(int64_t x, int64_t q)
+{
+    return (x * q + ((int64_t)1 << 23)) >> 24;
+}
+
+/**
+ * @brief product of x and the Q22 number q, rounded; x keeps its format
+ */
+inline int64_t mulQ22(int64_t x, int64_t q)
+{
+    return (x * q + ((int64_t)1 << (DPS__INT_SCALED_BITS - 1))) >> DPS__INT_SCALED_BITS;
+}
+
+/**
+ * @brief product of the Q8 number x and the Q22 number q as Q16 number, rounded
+ */
+inline int64_t mulQ22ToQ16(int64_t x, int64_t q)
+{
+    return (x * q + ((int64_t)1 << (DPS__INT_SCALED_BITS - DPS__INT_COEF_BITS - 1))) >>
+           (DPS__INT_SCALED_BITS - DPS__INT_COEF_BITS);
+}
+
+/**
+ * @brief x limited to the range of int32_t
+ */
+inline int32_t saturateInt32(int64_t x)
+{
+    if (x > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (x < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+    return (int32_t)x;
+}
+
+} // namespace dps
+
+#endif //DPSFIXEDPOINT_H_INCLUDED
@@ -0,0 +1,73 @@
+/**
+ * @brief Measurement configurations that are validated at compile time
+ *
+ * A firmware with a fixed configuration can describe it as DpsMeasurementConfig type and start it with
+ * startMeasureBothCont<Config>(). Combinations the sensor cannot handle are rejected by the compiler,
+ * and all register contents are computed at compile time, so no validation is done at runtime.
+ */
+
+#ifndef DPSMEASUREMENTCONFIG_H_INCLUDED
+#define DPSMEASUREMENTCONFIG_H_INCLUDED
+
+#include "util/dps_config.h"
+
+namespace dps
+{
+
+/**
+ * @brief time that the sensor needs for 2^mr measurements with an oversampling rate of 2^osr
+ * in units of 0.1 ms (see DpsClass::calcBusyTime)
+ */
+constexpr uint32_t busyTime(uint8_t mr, uint8_t osr)
+{
+    //formula from datasheet (optimized)
+    return ((uint32_t)20U << mr) + ((uint32_t)16U << (osr + mr));
+}
+
+/**
+ * @brief compensation scale factor for the oversampling rate 2^osr (see DpsClass::scaling_facts)
+ */
+constexpr int32_t scalingFactor(uint8_t osr)
+{
+    return osr == 0U ? 524288 : osr == 1U ? 1572864 : osr == 2U ? 3670016 : osr == 3U ? 7864320
+         : osr == 4U ? 253952 : osr == 5U ? 516096 : osr == 6U ? 1040384 : 2088960;
+}
+
+} // namespace dps
+
+/**
+ * @brief continuous measurement of temperature and pressure, fixed at compile time
+ *
+ * @tparam TempMr   measure rate for temperature, DPS__MEASUREMENT_RATE_1 ... DPS__MEASUREMENT_RATE_128
+ * @tparam TempOsr  oversampling rate for temperature, DPS__OVERSAMPLING_RATE_1 ... DPS__OVERSAMPLING_RATE_128
+ * @tparam PrsMr    measure rate for pressure
+ * @tparam PrsOsr   oversampling rate for pressure
+ */
+template <uint8_t TempMr, uint8_t TempOsr, uint8_t PrsMr, uint8_t PrsOsr>
+struct DpsMeasurementConfig
+{
+    static_assert(TempMr <= DPS__MEASUREMENT_RATE_128 && PrsMr <= DPS__MEASUREMENT_RATE_128, "measure rate out of range");
+    static_assert(TempOsr <= DPS__OVERSAMPLING_RATE_128 && PrsOsr <= DPS__OVERSAMPLING_RATE_128, "oversampling rate out of range");
+
+    static const uint8_t tempMr = TempMr;
+    static const uint8_t tempOsr = TempOsr;
+    static const uint8_t prsMr = PrsMr;
+    static const uint8_t prsOsr = PrsOsr;
+
+    // sum of both conversion times per second, in 0.1 ms
+    static const uint32_t busyTime = dps::busyTime(TempMr, TempOsr) + dps::busyTime(PrsMr, PrsOsr);
+    static_assert(busyTime < DPS310__MAX_BUSYTIME, "speed and precision are too high: conversions take longer than one second");
+
+    // contents of the rate and precision fields of TEMP_CFG and PRS_CFG
+    static const uint8_t tempCfg = RegFieldSet<dps::TEMP_MR, dps::TEMP_OSR>::encode(TempMr, TempOsr);
+    static const uint8_t prsCfg = RegFieldSet<dps::PRS_MR, dps::PRS_OSR>::encode(PrsMr, PrsOsr);
+
+    // result bit shift is required for oversampling rates above 8 (DPS310 only)
+    static const uint8_t tempShift = TempOsr > DPS310__OSR_SE ? 1U : 0U;
+    static const uint8_t prsShift = PrsOsr > DPS310__OSR_SE ? 1U : 0U;
+
+    static const int32_t tempScale = dps::scalingFactor(TempOsr);
+    static const int32_t prsScale = dps::scalingFactor(PrsOsr);
+};
+
+#endif //DPSMEASUREMENTCONFIG_H_INCLUDED
@@ -16,4 +16,85 @@ typedef struct
     uint8_t length;
 } RegBlock_t;
 
-#endif
\ No newline at end of file
+/**
+ * @brief A bit field of a sensor register, described completely at compile time
+ *
+ * Address, mask and shift are template arguments, so they are folded into the code
+ * instead of being looked up in a table and passed around at runtime.
+ * Inconsistent descriptions (mask bits below the shift, holes in the mask) are rejected by the compiler.
+ *
+ * @tparam RegAddress address of the register containing the field
+ * @tparam Mask bits of the register that belong to the field
+ * @tparam Shift position of the lowest bit of the field
+ */
+template <uint8_t RegAddress, uint8_t Mask, uint8_t Shift>
+struct RegField
+{
+    static const uint8_t regAddress = RegAddress;
+    static const uint8_t mask = Mask;
+    static const uint8_t shift = Shift;
+
+    static_assert(Shift < 8U && Mask != 0U, "empty register field");
+    static_assert(((Mask >> Shift) & 0x01U) != 0U && (uint8_t)((Mask >> Shift) << Shift) == Mask,
+                  "shift must point to the lowest bit of the mask");
+    static_assert(((Mask >> Shift) & ((Mask >> Shift) + 1U)) == 0U, "mask must be contiguous");
+
+    /**
+     * @brief places a value into the field
+     */
+    static constexpr uint8_t encode(uint8_t value)
+    {
+        return (uint8_t)((value << Shift) & Mask);
+    }
+
+    /**
+     * @brief extracts the value of the field from the register content
+     */
+    static constexpr uint8_t decode(uint8_t content)
+    {
+        return (uint8_t)((content & Mask) >> Shift);
+    }
+};
+
+/**
+ * @brief Several fields of the same register that are written together
+ *
+ * The fields must be located in the same register and must not overlap,
+ * otherwise the compiler rejects the combination.
+ * encode() combines all values into one byte at compile time, so a group is updated
+ * with a single read-modify-write.
+ */
+template <class... Fields>
+struct RegFieldSet;
+
+template <class Field>
+struct RegFieldSet<Field>
+{
+    static const uint8_t regAddress = Field::regAddress;
+    static const uint8_t mask = Field::mask;
+
+    static constexpr uint8_t encode(uint8_t value)
+    {
+        return Field::encode(value);
+    }
+};
+
+template <class Field, class... Rest>
+struct RegFieldSet<Field, Rest...>
+{
+    typedef RegFieldSet<Rest...> Tail;
+
+    static_assert(Field::regAddress == Tail::regAddress, "fields of a set must belong to the same register");
+    static_assert((Field::mask & Tail::mask) == 0U, "fields of a set must not overlap");
+
+    static const uint8_t regAddress = Field::regAddress;
+    static const uint8_t mask = Field::mask | Tail::mask;
+
+    template <class... Values>
+    static constexpr uint8_t encode(uint8_t value, Values... rest)
+    {
+        return (uint8_t)(Field::encode(value) | Tail::encode(rest...));
+    }
+};
+
+#endif
@@ -1,7 +1,7 @@
 #ifndef DPS310_CONFIG_H_
 #define DPS310_CONFIG_H_
 
-#define DPS310_NUM_OF_REGMASKS 16
+#include "util/dps_config.h"
 
 enum Interrupt_source_310_e
 {
@@ -15,35 +15,33 @@ enum Interrupt_source_310_e
 namespace dps310
 {
 
-enum Registers_e
-{
-    PROD_ID = 0,
-    REV_ID,
-    TEMP_SENSOR,    // internal vs external
-    TEMP_SENSORREC, //temperature sensor recommendation
-    TEMP_SE,        //temperature shift enable (if temp_osr>3)
-    PRS_SE,         //pressure shift enable (if prs_osr>3)
-    FIFO_FL,        //FIFO flush
-    FIFO_EMPTY,     //FIFO empty
-    FIFO_FULL,      //FIFO full
-    INT_HL,
-    INT_SEL,         //interrupt select
-};
+typedef RegField<0x0D, 0x0F, 0> PROD_ID;
+typedef RegField<0x0D, 0xF0, 4> REV_ID;
+typedef RegField<0x07, 0x80, 7> TEMP_SENSOR;    // internal vs external
+typedef RegField<0x28, 0x80, 7> TEMP_SENSORREC; //temperature sensor recommendation
+typedef RegField<0x09, 0x08, 3> TEMP_SE;        //temperature shift enable (if temp_osr>3)
+typedef RegField<0x09, 0x04, 2> PRS_SE;         //pressure shift enable (if prs_osr>3)
+typedef RegField<0x0C, 0x80, 7> FIFO_FL;        //FIFO flush
+typedef RegField<0x0C, 0x0F, 0> SOFT_RESET;
+typedef RegField<0x08, 0x80, 7> COEF_RDY;       //coefficients available
+typedef RegField<0x08, 0x40, 6> SENSOR_RDY;     //sensor initialization complete
+typedef RegField<0x0B, 0x01, 0> FIFO_EMPTY;     //FIFO empty
+typedef RegField<0x0B, 0x02, 1> FIFO_FULL;      //FIFO full
+typedef RegField<0x09, 0x80, 7> INT_HL;
+typedef RegField<0x09, 0x70, 4> INT_SEL;        //interrupt select
 
-const RegMask_t registers[DPS310_NUM_OF_REGMASKS] = {
-    {0x0D, 0x0F, 0}, // PROD_ID
-    {0x0D, 0xF0, 4}, // REV_ID
-    {0x07, 0x80, 7}, // TEMP_SENSOR
-    {0x28, 0x80, 7}, // TEMP_SENSORREC
-    {0x09, 0x08, 3}, // TEMP_SE
-    {0x09, 0x04, 2}, // PRS_SE
-    {0x0C, 0x80, 7}, // FIFO_FL
-    {0x0B, 0x01, 0}, // FIFO_EMPTY
-    {0x0B, 0x02, 1}, // FIFO_FULL
-    {0x09, 0x80, 7}, // INT_HL
-    {0x09, 0x70, 4}, // INT_SEL
-};
+// fields sharing a register must not overlap
+static_assert(RegFieldSet<TEMP_SENSOR, dps::TEMP_MR, dps::TEMP_OSR>::mask == 0xF7, "TEMP_CFG fields overlap");
+static_assert(RegFieldSet<INT_HL, INT_SEL, TEMP_SE, PRS_SE, dps::FIFO_EN>::mask == 0xFE, "CFG_REG fields overlap");
+static_assert(RegFieldSet<FIFO_EMPTY, FIFO_FULL>::mask == 0x03, "FIFO_STS fields overlap");
+static_assert(RegFieldSet<FIFO_FL, SOFT_RESET>::mask == 0x8F, "RESET fields overlap");
+static_assert(RegFieldSet<COEF_RDY, SENSOR_RDY, dps::TEMP_RDY, dps::PRS_RDY, dps::MSR_CTRL>::mask == 0xF7, "MEAS_CFG fields overlap");
 
 const RegBlock_t coeffBlock = {0x10, 18};
+// PROD_ID, coefficients and TEMP_SENSORREC, read in one burst by init()
+#define DPS310__INIT_BLOCK_LENGTH 28U
+const RegBlock_t initBlock = {0x0D, DPS310__INIT_BLOCK_LENGTH};
+static_assert(0x0D + DPS310__INIT_BLOCK_LENGTH == TEMP_SENSORREC::regAddress + 1U, "init block must end with TEMP_SENSORREC");
+static_assert(DPS310__INIT_BLOCK_LENGTH <= DPS__MAX_BLOCK_LENGTH, "init block too long for one transfer");
 } // namespace dps310
 #endif
\ No newline at end of file
@@ -2,17 +2,19 @@
 #ifndef DPS422_CONFIG_H_
 #define DPS422_CONFIG_H_
 
+#include "util/dps_config.h"
+
 // consts for temperature calculation
 #define DPS422_T_REF 27
 #define DPS422_V_BE_TARGET 0.687027
 #define DPS422_ALPHA 9.45
+// alpha as Q24 number for the integer compensation, folded at compile time
+#define DPS422_ALPHA_Q24 ((int32_t)(DPS422_ALPHA * 16777216.0 + 0.5))
 #define DPS422_T_C_VBE -1.735e-3
 #define DPS422_K_PTAT_CORNER -0.8
 #define DPS422_K_PTAT_CURVATURE 0.039
 #define DPS422_A_0 5030
 
-#define DPS422_NUM_OF_REGMASKS 20
-
 enum Interrupt_source_420_e
 {
     DPS422_NO_INTR = 0,
@@ -25,50 +27,31 @@ enum Interrupt_source_420_e
 
 namespace dps422
 {
-enum Registers_e
-{
-    // flags
-    CONT_FLAG = 0, // continuous mode flag
-    INIT_DONE,     // set when initialisation procedure is complete
-    // interrupt config
-    INTR_SEL, // interrupt select
-    INTR_POL, // interrupt active polarity
-    // fifo config
-    WM,              // watermark level
-    FIFO_FL,         // FIFO flush
-    FIFO_EMPTY,      // FIFO empty
-    FIFO_FULL,       // if FIFO is full or reaches watermark level
-    FIFO_FULL_CONF,  // Configures FIFO behaviour when full
-    FIFO_FILL_LEVEL, //contains the number of pressure and/or temperature measurements currently stored in FIFO
-    // misc
-    PROD_ID,
-    REV_ID,
-    SPI_MODE, // 4- or 3-wire SPI
-    SOFT_RESET,
-    MUST_SET, // bit 7 of TEMP_CFG, according to datasheet should always be set
-};
+// flags
+typedef RegField<0x08, 0x40, 6> CONT_FLAG; // continuous mode flag
+typedef RegField<0x08, 0x80, 7> INIT_DONE; // set when initialisation procedure is complete
+// interrupt config
+typedef RegField<0x09, 0xF0, 4> INTR_SEL; // interrupt select
+typedef RegField<0x09, 0x08, 3> INTR_POL; // interrupt active polarity
+// fifo config
+typedef RegField<0x0B, 0x1F, 0> WM;              // watermark level
+typedef RegField<0x0D, 0x80, 7> FIFO_FL;         // FIFO flush
+typedef RegField<0x0C, 0x01, 0> FIFO_EMPTY;      // FIFO empty
+typedef RegField<0x0C, 0x02, 1> FIFO_FULL;       // if FIFO is full or reaches watermark level
+typedef RegField<0x09, 0x04, 2> FIFO_FULL_CONF;  // Configures FIFO behaviour when full
+typedef RegField<0x0C, 0xFC, 2> FIFO_FILL_LEVEL; //contains the number of pressure and/or temperature measurements currently stored in FIFO
+// misc
+typedef RegField<0x1D, 0x0F, 0> PROD_ID;
+typedef RegField<0x1D, 0xF0, 4> REV_ID;
+typedef RegField<0x09, 0x01, 0> SPI_MODE; // 4- or 3-wire SPI
+typedef RegField<0x0D, 0x0F, 0> SOFT_RESET;
+typedef RegField<0x07, 0x80, 7> MUST_SET; // bit 7 of TEMP_CFG, according to datasheet should always be set
 
-const RegMask_t registers[DPS422_NUM_OF_REGMASKS] = {
-    // flags
-    {0x08, 0x40, 6}, // CONT_FLAG
-    {0x08, 0x80, 7}, // INIT_DONE
-    // interrupt config
-    {0x09, 0xF0, 4}, // INTR_SEL
-    {0x09, 0x80, 3}, // INTR_POL
-    // /fifo config
-    {0x0B, 0x1F, 0}, // WM
-    {0x0D, 0x80, 7}, // FIFO_FL
-    {0x0C, 0x01, 0}, // FIFO_EMPTY
-    {0x0C, 0x02, 1}, // FIFO_FULL
-    {0x09, 0x04, 2}, // FIFO_FULL_CONF
-    {0x0C, 0xFC, 2}, // FIFO_FILL_LEVEL
-    // misc
-    {0x1D, 0x0F, 0}, // PROD_ID
-    {0x1D, 0xF0, 0}, // REV_ID
-    {0x09, 0x01, 0}, // SPI_MODE
-    {0x0D, 0x0F, 0}, // SOFT_RESET
-    {0x07, 0x80, 7}, // MUST_SET
-};
+// fields sharing a register must not overlap
+static_assert(RegFieldSet<MUST_SET, dps::TEMP_MR, dps::TEMP_OSR>::mask == 0xF7, "TEMP_CFG fields overlap");
+static_assert(RegFieldSet<INTR_SEL, INTR_POL, FIFO_FULL_CONF, dps::FIFO_EN, SPI_MODE>::mask == 0xFF, "INT_FIFO_CFG fields overlap");
+static_assert(RegFieldSet<FIFO_FILL_LEVEL, FIFO_FULL, FIFO_EMPTY>::mask == 0xFF, "FIFO_STS fields overlap");
+static_assert(RegFieldSet<FIFO_FL, SOFT_RESET>::mask == 0x8F, "RESET fields overlap");
 
 enum RegisterBlocks_e
 {
@@ -80,6 +63,16 @@ const RegBlock_t coeffBlocks[4] = {
     {0x20, 3},
     {0x26, 20},
 };
+// PROD_ID and both coefficient blocks, read in one burst by init()
+#define DPS422__INIT_BLOCK_LENGTH 29U
+const RegBlock_t initBlock = {0x1D, DPS422__INIT_BLOCK_LENGTH};
+static_assert(0x1D + DPS422__INIT_BLOCK_LENGTH == 0x26 + 20, "init block must end with the pressure coefficients");
+static_assert(DPS422__INIT_BLOCK_LENGTH <= DPS__MAX_BLOCK_LENGTH, "init block too long for one transfer");
+
+// pressure and temperature results, PRS_CFG, TEMP_CFG, MEAS_CFG with the ready flags and INT_STS, read in one burst;
+// reading INT_STS clears the ready interrupt of a measurement of both
+const RegBlock_t bothResultsBlock = dps::readyBlock;
+#define DPS422__BOTH_RESULTS_MEAS_CFG 8U
 
 } // namespace dps422
 
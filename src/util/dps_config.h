@@ -30,7 +30,24 @@
 #define DPS__FIFO_SIZE 32
 #define DPS__STD_SLAVE_ADDRESS 0x77U
 #define DPS__RESULT_BLOCK_LENGTH 3
-#define NUM_OF_COMMON_REGMASKS 16
+// value read from the result registers if the FIFO is empty (0x800000)
+#define DPS__FIFO_EMPTY_VALUE ((int32_t)-8388608)
+// maximum number of FIFO results read in one batch
+#define DPS__FIFO_BATCH 8
+// longest block read in one transfer, limited by the receive buffer of the Arduino Wire library
+#define DPS__MAX_BLOCK_LENGTH 32U
+
+// configuration registers PRS_CFG, TEMP_CFG, MEAS_CFG and CFG_REG, cached for DpsClass::recover()
+#define DPS__CFG_SHADOW_START 0x06U
+#define DPS__CFG_SHADOW_LENGTH 4U
+// failed bus accesses in a row after which getContResults calls DpsClass::recover()
+#ifndef DPS__RECOVERY_THRESHOLD
+#define DPS__RECOVERY_THRESHOLD 3U
+#endif
+// content of the soft reset field of both sensors
+#define DPS__SOFT_RESET_CMD 0x09U
+// maximum time after a soft reset until the sensor and its coefficients are ready, in ms
+#define DPS__RESET_TIMEOUT 40U
 
 #define DPS__MEASUREMENT_RATE_1 0
 #define DPS__MEASUREMENT_RATE_2 1
@@ -55,6 +72,16 @@
 
 #define DPS__NUM_OF_SCAL_FACTS 8
 
+// units of the integer results: temperature in 0.001 °C, pressure in 0.01 Pa
+#define DPS__INT_TEMP_SCALE 1000
+#define DPS__INT_PRS_SCALE 100
+
+// forms of the last scaled temperature that are up to date (see DpsClass::m_lastTempScalValid)
+#define DPS__TEMP_SCAL_FLOAT 0x01U
+#define DPS__TEMP_SCAL_Q24 0x02U
+// the pressure polynomial with the last temperature folded in (see DpsClass::m_prsPoly)
+#define DPS__TEMP_SCAL_POLY 0x04U
+
 // status code
 #define DPS__SUCCEEDED 0
 #define DPS__FAIL_UNKNOWN -1
@@ -80,6 +107,15 @@ enum Mode
     CONT_BOTH = 0x07
 };
 
+/**
+ * @brief type of a result, the same as the LSB of a FIFO entry
+ */
+enum SampleType_e
+{
+    SAMPLE_TEMP = 0,
+    SAMPLE_PRS = 1,
+};
+
 enum RegisterBlocks_e
 {
     PRS = 0, // pressure value
@@ -91,40 +127,32 @@ const RegBlock_t registerBlocks[2] = {
     {0x03, 3},
 };
 
+// both results, the configuration with the ready flags and INT_STS, read in one burst after a ready interrupt;
+// reading INT_STS clears the interrupt
+const RegBlock_t readyBlock = {0x00, 11};
+#define DPS__READY_BLOCK_LENGTH 11U
+
 /**
  * @brief registers for configuration and flags; these are the same for both 310 and 422, might need to be adapted for future sensors
  * 
  */
-enum Config_Registers_e
-{
-    TEMP_MR = 0, // temperature measure rate
-    TEMP_OSR,    // temperature measurement resolution
-    PRS_MR,      // pressure measure rate
-    PRS_OSR,     // pressure measurement resolution
-    MSR_CTRL,    // measurement control
-    FIFO_EN,
-
-    TEMP_RDY,
-    PRS_RDY,
-    INT_FLAG_FIFO,
-    INT_FLAG_TEMP,
-    INT_FLAG_PRS,
-};
-
-const RegMask_t config_registers[NUM_OF_COMMON_REGMASKS] = {
-    {0x07, 0x70, 4}, // TEMP_MR
-    {0x07, 0x07, 0}, // TEMP_OSR
-    {0x06, 0x70, 4}, // PRS_MR
-    {0x06, 0x07, 0}, // PRS_OSR
-    {0x08, 0x07, 0}, // MSR_CTRL
-    {0x09, 0x02, 1}, // FIFO_EN
-
-    {0x08, 0x20, 5}, // TEMP_RDY
-    {0x08, 0x10, 4}, // PRS_RDY
-    {0x0A, 0x04, 2}, // INT_FLAG_FIFO
-    {0x0A, 0x02, 1}, // INT_FLAG_TEMP
-    {0x0A, 0x01, 0}, // INT_FLAG_PRS
-};
+typedef RegField<0x07, 0x70, 4> TEMP_MR;  // temperature measure rate
+typedef RegField<0x07, 0x07, 0> TEMP_OSR; // temperature measurement resolution
+typedef RegField<0x06, 0x70, 4> PRS_MR;   // pressure measure rate
+typedef RegField<0x06, 0x07, 0> PRS_OSR;  // pressure measurement resolution
+typedef RegField<0x08, 0x07, 0> MSR_CTRL; // measurement control
+typedef RegField<0x09, 0x02, 1> FIFO_EN;
+
+typedef RegField<0x08, 0x20, 5> TEMP_RDY;
+typedef RegField<0x08, 0x10, 4> PRS_RDY;
+typedef RegField<0x0A, 0x04, 2> INT_FLAG_FIFO;
+typedef RegField<0x0A, 0x02, 1> INT_FLAG_TEMP;
+typedef RegField<0x0A, 0x01, 0> INT_FLAG_PRS;
+
+static_assert(RegFieldSet<PRS_MR, PRS_OSR>::mask == 0x77, "PRS_CFG fields overlap");
+static_assert(RegFieldSet<TEMP_RDY, PRS_RDY, MSR_CTRL>::mask == 0x37, "MEAS_CFG fields overlap");
+static_assert(RegFieldSet<INT_FLAG_FIFO, INT_FLAG_TEMP, INT_FLAG_PRS>::mask == 0x07, "INT_STS fields overlap");
+static_assert(INT_FLAG_PRS::regAddress + 1U == DPS__READY_BLOCK_LENGTH, "ready block must end with INT_STS");
 
 } // namespace dps
 #endif /* DPS_CONSTS_H_ */